@@ -1,8 +1,10 @@
 #include "ahrs/AHRS.h"
 #include <cmath>
+#include "core/PayloadIMU.h"
 
 AHRS::AHRS(const float updateFrequencyHz) 
-    : mUpdatePeriod(1.0f / updateFrequencyHz)
+    : mAnglesValid(true)
+    , mClock(updateFrequencyHz)
 {
     // Initialize quaternion to identity
     mQuat[0] = 1.0f;
@@ -16,18 +18,15 @@ AHRS::AHRS(const float updateFrequencyHz)
     mAngles[2] = 0.0f;
 }
 
-float AHRS::invSqrt(const float x)
+void AHRS::update(const Payload_IMU_t* samples, const size_t count)
 {
-    float halfx = 0.5f * x;
-    float y = x;
-    long i = *(long*)&y;
-    i = 0x5f3759df - (i>>1);
-    y = *(float*)&i;
-    y = y * (1.5f - (halfx * y * y));
-    return y;
+    for (size_t i = 0; i < count; ++i)
+    {
+        update(samples[i]);
+    }
 }
 
-void AHRS::quatToAngles()
+void AHRS::quatToAngles() const
 {
     static const float RAD_TO_DEG = 180.0f / M_PI;
     
@@ -42,4 +41,5 @@ void AHRS::quatToAngles()
     }
     mAngles[0] = atan2(2 * (mQuat[0] * mQuat[1] + mQuat[2] * mQuat[3]), 1 - 2 * (mQuat[1] * mQuat[1] + mQuat[2] * mQuat[2])) * RAD_TO_DEG;
     mAngles[2] = atan2(2 * (mQuat[0] * mQuat[3] + mQuat[1] * mQuat[2]), 1 - 2 * (mQuat[2] * mQuat[2] + mQuat[3] * mQuat[3])) * RAD_TO_DEG;
+    mAnglesValid = true;
 } 
\ No newline at end of file
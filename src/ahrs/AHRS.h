@@ -1,5 +1,11 @@
 #pragma once
 
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include "ahrs/InvSqrt.h"
+#include "ahrs/SampleClock.h"
+
 typedef struct Payload_IMU_s Payload_IMU_t;
 
 /**
@@ -14,7 +20,7 @@ public:
     /**
      * @brief Constructor with update frequency
      * 
-     * @param updateFrequencyHz The update frequency in Hz
+     * @param updateFrequencyHz The nominal update frequency in Hz, used when the samples carry no usable timestamps
      */
     explicit AHRS(const float updateFrequencyHz);
     
@@ -29,6 +35,17 @@ public:
      * @param payload The IMU payload data
      */
     virtual void update(const Payload_IMU_t& payload) = 0;
+
+    /**
+     * @brief Process consecutive IMU samples to update orientation
+     * 
+     * Equivalent to calling update() on each sample in order. Implementations
+     * run the whole span without per-sample dispatch.
+     * 
+     * @param samples The IMU samples, oldest first
+     * @param count Number of samples
+     */
+    virtual void update(const Payload_IMU_t* samples, const size_t count);
     
     /**
      * @brief Get the quaternion representing orientation
@@ -40,25 +57,57 @@ public:
     /**
      * @brief Get the Euler angles representing orientation
      * 
+     * The angles are derived from the quaternion on the first call after an
+     * update, updates themselves never pay for the conversion.
+     * 
      * @return Pointer to the angles array [roll, pitch, yaw] in degrees
      */
-    inline const float* getAngles() const { return mAngles; }
+    inline const float* getAngles() const
+    {
+        if (!mAnglesValid)
+        {
+            quatToAngles();
+        }
+        return mAngles;
+    }
 
 protected:
     /**
      * @brief Convert quaternion to Euler angles
      */
-    void quatToAngles();
+    void quatToAngles() const;
     
     /**
-     * @brief Fast inverse square-root
+     * @brief Get the integration period of a sample from its timestamp
+     * 
+     * The time elapsed since the previous sample, with the fallbacks to the
+     * nominal period described in SampleClock.
+     * 
+     * @param payload The IMU payload data
+     * @return Integration period in seconds
+     */
+    inline float samplePeriod(const Payload_IMU_t& payload) { return mClock.period(payload); }
+
+    /**
+     * @brief Inverse square-root used by the normalisations
+     * 
+     * Implemented by the InvSqrtPolicy selected at build time, see InvSqrt.h.
+     * 
+     * @param x Input value
+     * @return Inverse square root of x
+     */
+    static inline float invSqrt(const float x) { return InvSqrtPolicy::apply(x); }
+
+    /**
+     * @brief Inverse square-root of the double precision filters, always exact
      * 
      * @param x Input value
      * @return Inverse square root of x
      */
-    static float invSqrt(const float x);
+    static inline double invSqrt(const double x) { return 1.0 / std::sqrt(x); }
     
     float mQuat[4];        ///< Quaternion [w, x, y, z]
-    float mAngles[3];      ///< Euler angles [roll, pitch, yaw] in degrees
-    float mUpdatePeriod;   ///< Update period in seconds
+    mutable float mAngles[3]; ///< Euler angles [roll, pitch, yaw] in degrees, valid if mAnglesValid
+    mutable bool mAnglesValid; ///< false once the quaternion changed since the last conversion
+    SampleClock mClock;    ///< Integration periods of the samples, from their timestamps
 }; 
\ No newline at end of file
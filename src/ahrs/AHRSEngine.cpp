@@ -0,0 +1,399 @@
+#include <algorithm>
+#include <cstring>
+#include <ctime>
+#include <sched.h>
+#include <spdlog/spdlog.h>
+#include <unistd.h>
+
+#include "ahrs/AHRSEngine.h"
+#include "core/PayloadIMU.h"
+#include "utils/ScopedLock.h"
+
+namespace
+{
+inline uint64_t monotonicNs()
+{
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return static_cast<uint64_t>(now.tv_sec) * 1000000000ULL + static_cast<uint64_t>(now.tv_nsec);
+}
+
+inline size_t onlineCpus()
+{
+    const long count = sysconf(_SC_NPROCESSORS_ONLN);
+    return count > 0 ? static_cast<size_t>(count) : 1;
+}
+} // end of anonymous namespace
+
+AHRSEngine::Stream::Stream(const uint32_t id, const size_t home, std::optional<VariantAHRS>&& ahrs)
+    : mId(id)
+    , mHome(home)
+    , mPending()
+    , mWorking()
+    , mScheduled(false)
+    , mAhrs(std::move(ahrs))
+    , mQuat{1.0f, 0.0f, 0.0f, 0.0f}
+{
+    pthread_mutex_init(&mLock, nullptr);
+}
+
+AHRSEngine::Stream::~Stream()
+{
+    pthread_mutex_destroy(&mLock);
+}
+
+AHRSEngine::Worker::Worker()
+    : mEngine(nullptr)
+    , mIndex(0)
+    , mThread(0)
+    , mQueue()
+    , mIdle(false)
+    , mSamples(0)
+{
+    pthread_mutex_init(&mLock, nullptr);
+    pthread_cond_init(&mWakeup, nullptr);
+}
+
+AHRSEngine::Worker::~Worker()
+{
+    pthread_cond_destroy(&mWakeup);
+    pthread_mutex_destroy(&mLock);
+}
+
+AHRSEngine::AHRSEngine(const size_t workerCount, const AHRSType type, const float updateFrequencyHz,
+                       const bool ignoreMagnetometer, const AHRSPrecision precision, const bool pinWorkers)
+    : mType(type)
+    , mUpdateFrequencyHz(updateFrequencyHz)
+    , mIgnoreMagnetometer(ignoreMagnetometer)
+    , mPrecision(precision)
+    , mPinWorkers(pinWorkers)
+    , mWorkers()
+    , mStreams()
+    , mRunning(false)
+    , mRunnable(0)
+    , mSubmitted(0)
+    , mProcessed(0)
+    , mMaxQueued(0)
+    , mTurns(0)
+    , mSteals(0)
+    , mStartNs(0)
+{
+    const size_t count = workerCount > 0 ? workerCount : onlineCpus();
+    for (size_t i = 0; i < count; ++i)
+    {
+        mWorkers.emplace_back(new Worker());
+        mWorkers.back()->mEngine = this;
+        mWorkers.back()->mIndex = i;
+    }
+    pthread_rwlock_init(&mStreamsLock, nullptr);
+    pthread_mutex_init(&mIdleLock, nullptr);
+    pthread_cond_init(&mDrained, nullptr);
+}
+
+AHRSEngine::~AHRSEngine()
+{
+    stop();
+    pthread_cond_destroy(&mDrained);
+    pthread_mutex_destroy(&mIdleLock);
+    pthread_rwlock_destroy(&mStreamsLock);
+}
+
+bool AHRSEngine::start()
+{
+    mStartNs = monotonicNs();
+    mRunning.store(true, std::memory_order_release);
+
+    const size_t cpus = onlineCpus();
+    for (std::unique_ptr<Worker>& worker : mWorkers)
+    {
+        pthread_attr_t attr;
+        pthread_attr_init(&attr);
+        if (mPinWorkers)
+        {
+            cpu_set_t cpuSet;
+            CPU_ZERO(&cpuSet);
+            CPU_SET(worker->mIndex % cpus, &cpuSet);
+            pthread_attr_setaffinity_np(&attr, sizeof(cpuSet), &cpuSet);
+        }
+        const int retVal = pthread_create(&worker->mThread, &attr, AHRSEngine::startWorker, worker.get());
+        pthread_attr_destroy(&attr);
+        if (retVal != 0)
+        {
+            spdlog::error("Failed to start AHRS worker {}: {}", worker->mIndex, strerror(retVal));
+            worker->mThread = 0;
+            stop();
+            return false;
+        }
+    }
+    spdlog::info("AHRS engine started with {} workers{}", mWorkers.size(), mPinWorkers ? ", pinned to CPUs" : "");
+    return true;
+}
+
+void AHRSEngine::stop()
+{
+    if (!mRunning.exchange(false, std::memory_order_acq_rel))
+    {
+        return;
+    }
+    {
+        ScopedLock lock(mIdleLock);
+        for (std::unique_ptr<Worker>& worker : mWorkers)
+        {
+            pthread_cond_signal(&worker->mWakeup);
+        }
+        // waitIdle() gives up once the engine stopped, samples left in the queues are never processed
+        pthread_cond_broadcast(&mDrained);
+    }
+    for (std::unique_ptr<Worker>& worker : mWorkers)
+    {
+        if (worker->mThread > 0)
+        {
+            pthread_join(worker->mThread, nullptr);
+            worker->mThread = 0;
+        }
+    }
+}
+
+bool AHRSEngine::addStream(const uint32_t streamId)
+{
+    pthread_rwlock_wrlock(&mStreamsLock);
+    bool retVal = false;
+    if (mStreams.find(streamId) == mStreams.end())
+    {
+        const size_t home = mStreams.size() % mWorkers.size();
+        mStreams.emplace(streamId, std::make_unique<Stream>(
+            streamId, home, VariantAHRS::create(mType, mUpdateFrequencyHz, mIgnoreMagnetometer, mPrecision)));
+        retVal = true;
+    }
+    pthread_rwlock_unlock(&mStreamsLock);
+    return retVal;
+}
+
+bool AHRSEngine::submit(const uint32_t streamId, const Payload_IMU_t* samples, const size_t count)
+{
+    Stream* stream = findStream(streamId);
+    if (stream == nullptr)
+    {
+        return false;
+    }
+
+    // Counted before the samples become visible, so that the processed count never overtakes it
+    const uint64_t submitted = mSubmitted.fetch_add(count, std::memory_order_relaxed) + count;
+    const uint64_t queued = submitted - mProcessed.load(std::memory_order_relaxed);
+    uint64_t maxQueued = mMaxQueued.load(std::memory_order_relaxed);
+    while (queued > maxQueued && !mMaxQueued.compare_exchange_weak(maxQueued, queued, std::memory_order_relaxed))
+    {
+    }
+
+    bool schedule = false;
+    {
+        ScopedLock lock(stream->mLock);
+        stream->mPending.insert(stream->mPending.end(), samples, samples + count);
+        schedule = !stream->mScheduled;
+        stream->mScheduled = true;
+    }
+    if (schedule)
+    {
+        enqueue(*stream, stream->mHome, true);
+    }
+    return true;
+}
+
+void AHRSEngine::waitIdle()
+{
+    ScopedLock lock(mIdleLock);
+    while (mRunning.load(std::memory_order_acquire)
+           && mProcessed.load(std::memory_order_acquire) < mSubmitted.load(std::memory_order_acquire))
+    {
+        pthread_cond_wait(&mDrained, &mIdleLock);
+    }
+}
+
+bool AHRSEngine::getQuaternion(const uint32_t streamId, float quat[4]) const
+{
+    Stream* stream = findStream(streamId);
+    if (stream == nullptr)
+    {
+        return false;
+    }
+    ScopedLock lock(stream->mLock);
+    memcpy(quat, stream->mQuat, sizeof(stream->mQuat));
+    return true;
+}
+
+AHRSEngine::Metrics AHRSEngine::getMetrics() const
+{
+    Metrics metrics;
+    pthread_rwlock_rdlock(&mStreamsLock);
+    metrics.mStreams = mStreams.size();
+    pthread_rwlock_unlock(&mStreamsLock);
+    metrics.mWorkers = mWorkers.size();
+    metrics.mSamplesProcessed = mProcessed.load(std::memory_order_acquire);
+    metrics.mSamplesSubmitted = std::max(mSubmitted.load(std::memory_order_acquire), metrics.mSamplesProcessed);
+    metrics.mTurns = mTurns.load(std::memory_order_relaxed);
+    metrics.mSteals = mSteals.load(std::memory_order_relaxed);
+    metrics.mQueuedSamples = metrics.mSamplesSubmitted - metrics.mSamplesProcessed;
+    metrics.mMaxQueuedSamples = mMaxQueued.load(std::memory_order_relaxed);
+    metrics.mRunnableStreams = mRunnable.load(std::memory_order_relaxed);
+    metrics.mElapsedSeconds = mStartNs > 0 ? static_cast<double>(monotonicNs() - mStartNs) * 1e-9 : 0.0;
+    for (const std::unique_ptr<Worker>& worker : mWorkers)
+    {
+        metrics.mWorkerSamples.push_back(worker->mSamples.load(std::memory_order_relaxed));
+    }
+    return metrics;
+}
+
+void AHRSEngine::logStatistics() const
+{
+    const Metrics metrics = getMetrics();
+    const double rate = metrics.mElapsedSeconds > 0.0 ? metrics.mSamplesProcessed / metrics.mElapsedSeconds : 0.0;
+    spdlog::info("AHRS engine: {} streams on {} workers, {} samples processed ({:.0f}/s) in {} turns, {} stolen",
+                 metrics.mStreams, metrics.mWorkers, metrics.mSamplesProcessed, rate, metrics.mTurns, metrics.mSteals);
+    spdlog::info("AHRS engine queues: {} samples queued (max {}), {} runnable streams",
+                 metrics.mQueuedSamples, metrics.mMaxQueuedSamples, metrics.mRunnableStreams);
+    for (size_t i = 0; i < metrics.mWorkerSamples.size(); ++i)
+    {
+        spdlog::debug("AHRS worker {}: {} samples", i, metrics.mWorkerSamples[i]);
+    }
+}
+
+void* AHRSEngine::startWorker(void* instance)
+{
+    Worker* worker = static_cast<Worker*>(instance);
+    worker->mEngine->runWorker(*worker);
+    return nullptr;
+}
+
+void AHRSEngine::runWorker(Worker& worker)
+{
+    while (mRunning.load(std::memory_order_acquire))
+    {
+        Stream* stream = nullptr;
+        {
+            ScopedLock lock(worker.mLock);
+            if (!worker.mQueue.empty())
+            {
+                stream = worker.mQueue.front();
+                worker.mQueue.pop_front();
+            }
+        }
+        if (stream == nullptr)
+        {
+            stream = steal(worker);
+        }
+        if (stream != nullptr)
+        {
+            mRunnable.fetch_sub(1, std::memory_order_relaxed);
+            runStream(*stream, worker);
+            continue;
+        }
+
+        // Nothing to run or steal: sleep until a stream is queued for this worker or nobody else takes one
+        ScopedLock lock(mIdleLock);
+        worker.mIdle = true;
+        while (mRunning.load(std::memory_order_acquire) && mRunnable.load(std::memory_order_acquire) == 0)
+        {
+            pthread_cond_wait(&worker.mWakeup, &mIdleLock);
+        }
+        worker.mIdle = false;
+    }
+}
+
+void AHRSEngine::runStream(Stream& stream, Worker& worker)
+{
+    {
+        ScopedLock lock(stream.mLock);
+        stream.mPending.swap(stream.mWorking);
+    }
+
+    const size_t count = stream.mWorking.size();
+    if (stream.mAhrs)
+    {
+        stream.mAhrs->update(stream.mWorking.data(), count);
+    }
+    stream.mWorking.clear();
+
+    bool more = false;
+    {
+        ScopedLock lock(stream.mLock);
+        if (stream.mAhrs)
+        {
+            memcpy(stream.mQuat, stream.mAhrs->getQuaternion(), sizeof(stream.mQuat));
+        }
+        more = !stream.mPending.empty();
+        stream.mScheduled = more;
+    }
+
+    worker.mSamples.fetch_add(count, std::memory_order_relaxed);
+    mTurns.fetch_add(1, std::memory_order_relaxed);
+    const uint64_t processed = mProcessed.fetch_add(count, std::memory_order_acq_rel) + count;
+    if (processed == mSubmitted.load(std::memory_order_acquire))
+    {
+        ScopedLock lock(mIdleLock);
+        pthread_cond_broadcast(&mDrained);
+    }
+
+    // Samples that arrived during the turn are run on the home worker, behind the streams already waiting there.
+    // The home worker is not idle when it requeues its own stream, and nobody else needs waking for it
+    if (more)
+    {
+        enqueue(stream, stream.mHome, stream.mHome != worker.mIndex);
+    }
+}
+
+void AHRSEngine::enqueue(Stream& stream, const size_t workerIndex, const bool wake)
+{
+    Worker& home = *mWorkers[workerIndex];
+    mRunnable.fetch_add(1, std::memory_order_acq_rel);
+    {
+        ScopedLock lock(home.mLock);
+        home.mQueue.push_back(&stream);
+    }
+
+    if (!wake)
+    {
+        return;
+    }
+
+    // Prefer the home worker, an idle one only steals the stream if the home worker is busy
+    ScopedLock lock(mIdleLock);
+    if (home.mIdle)
+    {
+        pthread_cond_signal(&home.mWakeup);
+        return;
+    }
+    for (std::unique_ptr<Worker>& worker : mWorkers)
+    {
+        if (worker->mIdle)
+        {
+            pthread_cond_signal(&worker->mWakeup);
+            return;
+        }
+    }
+}
+
+AHRSEngine::Stream* AHRSEngine::steal(const Worker& thief)
+{
+    for (size_t i = 1; i < mWorkers.size(); ++i)
+    {
+        Worker& victim = *mWorkers[(thief.mIndex + i) % mWorkers.size()];
+        ScopedLock lock(victim.mLock);
+        if (!victim.mQueue.empty())
+        {
+            Stream* stream = victim.mQueue.back();
+            victim.mQueue.pop_back();
+            mSteals.fetch_add(1, std::memory_order_relaxed);
+            return stream;
+        }
+    }
+    return nullptr;
+}
+
+AHRSEngine::Stream* AHRSEngine::findStream(const uint32_t streamId) const
+{
+    pthread_rwlock_rdlock(&mStreamsLock);
+    const auto it = mStreams.find(streamId);
+    Stream* stream = it != mStreams.end() ? it->second.get() : nullptr;
+    pthread_rwlock_unlock(&mStreamsLock);
+    return stream;
+}
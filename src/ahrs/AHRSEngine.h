@@ -0,0 +1,224 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <optional>
+#include <pthread.h>
+#include <unordered_map>
+#include <vector>
+#include "ahrs/VariantAHRS.h"
+#include "core/AHRSPrecision.h"
+#include "core/AHRSType.h"
+
+typedef struct Payload_IMU_s Payload_IMU_t;
+
+/**
+ * @brief Runs the AHRS filters of many IMU streams in parallel on a work-stealing pool
+ *
+ * Every stream owns one filter and a queue of pending samples. A stream with
+ * pending samples is runnable and sits in the run queue of exactly one
+ * worker, so its samples are always processed in order by one thread at a
+ * time. A worker takes all samples queued for a stream in one turn.
+ *
+ * Each stream has a home worker and is queued there whenever it becomes
+ * runnable, which keeps its filter state in the caches of one core. A worker
+ * without work of its own steals runnable streams from the back of the other
+ * queues, and a stolen stream goes back to its home worker for its next turn.
+ */
+class AHRSEngine
+{
+public:
+    /**
+     * @brief Counters of the engine since start()
+     */
+    struct Metrics
+    {
+        size_t mStreams;             ///< Number of streams
+        size_t mWorkers;             ///< Number of worker threads
+        uint64_t mSamplesSubmitted;  ///< Samples handed to submit()
+        uint64_t mSamplesProcessed;  ///< Samples run through their filter
+        uint64_t mTurns;             ///< Stream turns, each processing all samples queued at its start
+        uint64_t mSteals;            ///< Turns taken from the run queue of another worker
+        uint64_t mQueuedSamples;     ///< Samples submitted and not processed yet
+        uint64_t mMaxQueuedSamples;  ///< Highest mQueuedSamples seen by submit()
+        size_t mRunnableStreams;     ///< Streams waiting in a run queue
+        double mElapsedSeconds;      ///< Time since start()
+        std::vector<uint64_t> mWorkerSamples; ///< Samples processed by each worker
+    };
+
+    /**
+     * @brief Constructor with the pool size and the filter configuration
+     *
+     * @param workerCount Number of worker threads, 0 for one per online CPU
+     * @param type The AHRS algorithm of every stream
+     * @param updateFrequencyHz The nominal update frequency of the streams in Hz
+     * @param ignoreMagnetometer Fuse the gyroscope and accelerometer only
+     * @param precision Scalar type the filters run with
+     * @param pinWorkers Pin worker i to CPU i modulo the number of online CPUs
+     */
+    AHRSEngine(const size_t workerCount, const AHRSType type, const float updateFrequencyHz,
+               const bool ignoreMagnetometer = false, const AHRSPrecision precision = AHRSPrecision::FLOAT,
+               const bool pinWorkers = false);
+
+    /**
+     * @brief Destructor stops the workers
+     */
+    ~AHRSEngine();
+
+    AHRSEngine(const AHRSEngine&) = delete;
+    AHRSEngine& operator=(const AHRSEngine&) = delete;
+
+    /**
+     * @brief Start the worker threads
+     *
+     * @return true if all workers were started
+     */
+    bool start();
+
+    /**
+     * @brief Stop the worker threads, samples still queued are not processed
+     */
+    void stop();
+
+    /**
+     * @brief Add a stream with a filter at the identity orientation
+     *
+     * Streams are assigned to their home worker round robin.
+     *
+     * @param streamId Identifier of the stream
+     * @return true if the stream was added, false if it already exists
+     */
+    bool addStream(const uint32_t streamId);
+
+    /**
+     * @brief Queue consecutive samples of a stream
+     *
+     * Samples of one stream must be submitted from one thread, or in an order
+     * the callers agree on, as they are processed in submission order.
+     *
+     * @param streamId Identifier of the stream
+     * @param samples The IMU samples, oldest first
+     * @param count Number of samples
+     * @return true if the samples were queued, false if the stream does not exist
+     */
+    bool submit(const uint32_t streamId, const Payload_IMU_t* samples, const size_t count);
+
+    /**
+     * @brief Wait until every submitted sample has been processed, or until stop() is called
+     */
+    void waitIdle();
+
+    /**
+     * @brief Get the quaternion of a stream after its latest turn
+     *
+     * @param streamId Identifier of the stream
+     * @param quat Receives the quaternion [w, x, y, z]
+     * @return true if the stream exists
+     */
+    bool getQuaternion(const uint32_t streamId, float quat[4]) const;
+
+    /**
+     * @brief Get the counters of the engine
+     *
+     * @return Snapshot of the metrics, the counters are read one by one while the workers run
+     */
+    Metrics getMetrics() const;
+
+    /**
+     * @brief Log throughput, queue depths and work distribution
+     */
+    void logStatistics() const;
+
+private:
+    /**
+     * @brief Filter and sample queue of one stream
+     */
+    struct alignas(64) Stream
+    {
+        uint32_t mId;                          ///< Identifier of the stream
+        size_t mHome;                          ///< Index of the home worker
+        pthread_mutex_t mLock;                 ///< Protects mPending, mScheduled and mQuat
+        std::vector<Payload_IMU_t> mPending;   ///< Samples waiting for the next turn
+        std::vector<Payload_IMU_t> mWorking;   ///< Samples of the current turn, only touched by its worker
+        bool mScheduled;                       ///< true while the stream is in a run queue or running
+        std::optional<VariantAHRS> mAhrs;      ///< The filter, empty with AHRSType::NONE
+        float mQuat[4];                        ///< Quaternion after the latest turn
+
+        Stream(const uint32_t id, const size_t home, std::optional<VariantAHRS>&& ahrs);
+        ~Stream();
+    };
+
+    /**
+     * @brief Thread of the pool and its run queue
+     */
+    struct alignas(64) Worker
+    {
+        AHRSEngine* mEngine;                   ///< Owning engine
+        size_t mIndex;                         ///< Index in mWorkers
+        pthread_t mThread;                     ///< Thread handle, 0 when not running
+        pthread_mutex_t mLock;                 ///< Protects mQueue
+        std::deque<Stream*> mQueue;            ///< Runnable streams, popped at the front by the worker
+        pthread_cond_t mWakeup;                ///< Signalled under mIdleLock when work is queued
+        bool mIdle;                            ///< true while waiting on mWakeup, protected by mIdleLock
+        std::atomic<uint64_t> mSamples;        ///< Samples processed by this worker
+
+        Worker();
+        ~Worker();
+    };
+
+    /**
+     * @brief Thread entry point of the workers
+     */
+    static void* startWorker(void* instance);
+
+    /**
+     * @brief Loop of a worker until stop()
+     */
+    void runWorker(Worker& worker);
+
+    /**
+     * @brief Process the samples queued for a stream and requeue it if more arrived meanwhile
+     */
+    void runStream(Stream& stream, Worker& worker);
+
+    /**
+     * @brief Put a runnable stream in the run queue of a worker
+     *
+     * @param stream The runnable stream
+     * @param workerIndex Index of the worker whose queue gets the stream
+     * @param wake Wake up that worker if it is idle, or any idle worker otherwise
+     */
+    void enqueue(Stream& stream, const size_t workerIndex, const bool wake);
+
+    /**
+     * @brief Take a runnable stream from the back of the queue of another worker, nullptr if none
+     */
+    Stream* steal(const Worker& thief);
+
+    /**
+     * @brief Find a stream, nullptr if it does not exist
+     */
+    Stream* findStream(const uint32_t streamId) const;
+
+    AHRSType mType;                   ///< Algorithm of the filters
+    float mUpdateFrequencyHz;         ///< Nominal update frequency of the filters
+    bool mIgnoreMagnetometer;         ///< Fuse the gyroscope and accelerometer only
+    AHRSPrecision mPrecision;         ///< Scalar type of the filters
+    bool mPinWorkers;                 ///< Pin the workers to CPUs
+    std::vector<std::unique_ptr<Worker>> mWorkers; ///< The pool
+    std::unordered_map<uint32_t, std::unique_ptr<Stream>> mStreams; ///< Streams by identifier
+    mutable pthread_rwlock_t mStreamsLock; ///< Protects mStreams, written by addStream() only
+    pthread_mutex_t mIdleLock;        ///< Protects the idle flags, mutex of the wakeup conditions
+    pthread_cond_t mDrained;          ///< Signalled under mIdleLock when all submitted samples were processed
+    std::atomic<bool> mRunning;       ///< Cleared by stop()
+    std::atomic<size_t> mRunnable;    ///< Streams in the run queues
+    std::atomic<uint64_t> mSubmitted; ///< Samples handed to submit()
+    std::atomic<uint64_t> mProcessed; ///< Samples run through their filter
+    std::atomic<uint64_t> mMaxQueued; ///< Highest number of queued samples seen by submit()
+    std::atomic<uint64_t> mTurns;     ///< Stream turns
+    std::atomic<uint64_t> mSteals;    ///< Stolen stream turns
+    uint64_t mStartNs;                ///< CLOCK_MONOTONIC time of start()
+};
@@ -2,40 +2,162 @@
 #include "ahrs/MadgwickAHRS.h"
 #include "core/PayloadIMU.h"
 
-MadgwickAHRS::MadgwickAHRS(const float updateFrequencyHz)
+template <typename Beta, SensorSet SENSORS, typename Scalar>
+MadgwickAHRS<Beta, SENSORS, Scalar>::MadgwickAHRS(const float updateFrequencyHz)
     : AHRS(updateFrequencyHz)
-    , mBeta(0.1f) // Default algorithm gain
+    , mQ{1, 0, 0, 0}
+    , mLastMag{0, 0, 0}
 {
 }
 
-void MadgwickAHRS::update(const Payload_IMU_t& payload)
+template <typename Beta, SensorSet SENSORS, typename Scalar>
+void MadgwickAHRS<Beta, SENSORS, Scalar>::update(const Payload_IMU_t& payload)
 {
-    float recipNorm;
-    float s0, s1, s2, s3;
-    float qDot1, qDot2, qDot3, qDot4;
-    float hx, hy;
-    float _2q0mx, _2q0my, _2q0mz, _2q1mx, _2bx, _2bz, _4bx, _4bz, _2q0, _2q1, _2q2, _2q3, _2q0q2, _2q2q3, q0q0, q0q1, q0q2, q0q3, q1q1, q1q2, q1q3, q2q2, q2q3, q3q3;
+    step(payload);
+    publish();
+}
+
+template <typename Beta, SensorSet SENSORS, typename Scalar>
+void MadgwickAHRS<Beta, SENSORS, Scalar>::update(const Payload_IMU_t* samples, const size_t count)
+{
+    for (size_t i = 0; i < count; ++i)
+    {
+        step(samples[i]);
+    }
+    publish();
+}
+
+template <typename Beta, SensorSet SENSORS, typename Scalar>
+inline void MadgwickAHRS<Beta, SENSORS, Scalar>::step(const Payload_IMU_t& payload)
+{
+    if constexpr (SENSORS == SensorSet::GYRO_ACCEL_MAG)
+    {
+        // A null field or a field repeated bit for bit means there is no new measurement
+        const bool magValid = !((payload.xMag == 0.0f) && (payload.yMag == 0.0f) && (payload.zMag == 0.0f))
+                              && !((payload.xMag == mLastMag[0]) && (payload.yMag == mLastMag[1])
+                                   && (payload.zMag == mLastMag[2]));
+        mLastMag[0] = payload.xMag;
+        mLastMag[1] = payload.yMag;
+        mLastMag[2] = payload.zMag;
+        if (magValid)
+        {
+            stepMARG(payload);
+            return;
+        }
+    }
+    stepIMU(payload);
+}
+
+template <typename Beta, SensorSet SENSORS, typename Scalar>
+inline void MadgwickAHRS<Beta, SENSORS, Scalar>::publish()
+{
+    for (int i = 0; i < 4; ++i)
+    {
+        mQuat[i] = static_cast<float>(mQ[i]);
+    }
+    mAnglesValid = false;
+}
+
+template <typename Beta, SensorSet SENSORS, typename Scalar>
+void MadgwickAHRS<Beta, SENSORS, Scalar>::stepIMU(const Payload_IMU_t& payload)
+{
+    Scalar recipNorm;
+    Scalar s0, s1, s2, s3;
+    Scalar qDot1, qDot2, qDot3, qDot4;
+    Scalar _2q0, _2q1, _2q2, _2q3, _4q0, _4q1, _4q2, _8q1, _8q2, q0q0, q1q1, q2q2, q3q3;
+
+    // Convert gyro data from mdeg/s to rad/s
+    const Scalar DEG_TO_RAD = static_cast<Scalar>(0.017453292);
+    const Scalar MDEG_TO_RAD = DEG_TO_RAD / 1000;
+    Scalar gx = payload.xGyro * MDEG_TO_RAD;
+    Scalar gy = payload.yGyro * MDEG_TO_RAD;
+    Scalar gz = payload.zGyro * MDEG_TO_RAD;
+
+    // Local copies of acceleration data
+    Scalar ax = payload.xAcc;
+    Scalar ay = payload.yAcc;
+    Scalar az = payload.zAcc;
+
+    // Rate of change of quaternion from gyroscope
+    qDot1 = 0.5f * (-mQ[1] * gx - mQ[2] * gy - mQ[3] * gz);
+    qDot2 = 0.5f * (mQ[0] * gx + mQ[2] * gz - mQ[3] * gy);
+    qDot3 = 0.5f * (mQ[0] * gy - mQ[1] * gz + mQ[3] * gx);
+    qDot4 = 0.5f * (mQ[0] * gz + mQ[1] * gy - mQ[2] * gx);
+
+    // Compute feedback only if accelerometer measurement valid (avoids NaN in accelerometer normalisation)
+    if(!((ax == 0.0f) && (ay == 0.0f) && (az == 0.0f)))
+    {
+        // Normalise accelerometer measurement
+        recipNorm = invSqrt(ax * ax + ay * ay + az * az);
+        ax *= recipNorm;
+        ay *= recipNorm;
+        az *= recipNorm;
+
+        // Auxiliary variables to avoid repeated arithmetic
+        _2q0 = 2.0f * mQ[0];
+        _2q1 = 2.0f * mQ[1];
+        _2q2 = 2.0f * mQ[2];
+        _2q3 = 2.0f * mQ[3];
+        _4q0 = 4.0f * mQ[0];
+        _4q1 = 4.0f * mQ[1];
+        _4q2 = 4.0f * mQ[2];
+        _8q1 = 8.0f * mQ[1];
+        _8q2 = 8.0f * mQ[2];
+        q0q0 = mQ[0] * mQ[0];
+        q1q1 = mQ[1] * mQ[1];
+        q2q2 = mQ[2] * mQ[2];
+        q3q3 = mQ[3] * mQ[3];
+
+        // Gradient decent algorithm corrective step
+        s0 = _4q0 * q2q2 + _2q2 * ax + _4q0 * q1q1 - _2q1 * ay;
+        s1 = _4q1 * q3q3 - _2q3 * ax + 4.0f * q0q0 * mQ[1] - _2q0 * ay - _4q1 + _8q1 * q1q1 + _8q1 * q2q2 + _4q1 * az;
+        s2 = 4.0f * q0q0 * mQ[2] + _2q0 * ax + _4q2 * q3q3 - _2q3 * ay - _4q2 + _8q2 * q1q1 + _8q2 * q2q2 + _4q2 * az;
+        s3 = 4.0f * q1q1 * mQ[3] - _2q1 * ax + 4.0f * q2q2 * mQ[3] - _2q2 * ay;
+        recipNorm = invSqrt(s0 * s0 + s1 * s1 + s2 * s2 + s3 * s3); // normalise step magnitude
+        s0 *= recipNorm;
+        s1 *= recipNorm;
+        s2 *= recipNorm;
+        s3 *= recipNorm;
+
+        // Apply feedback step
+        qDot1 -= BETA * s0;
+        qDot2 -= BETA * s1;
+        qDot3 -= BETA * s2;
+        qDot4 -= BETA * s3;
+    }
+
+    integrate(qDot1, qDot2, qDot3, qDot4, payload);
+}
+
+template <typename Beta, SensorSet SENSORS, typename Scalar>
+void MadgwickAHRS<Beta, SENSORS, Scalar>::stepMARG(const Payload_IMU_t& payload)
+{
+    Scalar recipNorm;
+    Scalar s0, s1, s2, s3;
+    Scalar qDot1, qDot2, qDot3, qDot4;
+    Scalar hx, hy;
+    Scalar _2q0mx, _2q0my, _2q0mz, _2q1mx, _2bx, _2bz, _4bx, _4bz, _2q0, _2q1, _2q2, _2q3, _2q0q2, _2q2q3, q0q0, q0q1, q0q2, q0q3, q1q1, q1q2, q1q3, q2q2, q2q3, q3q3;
 
     // Convert gyro data from mdeg/s to rad/s
-    const float DEG_TO_RAD = 0.017453292f;
-    const float MDEG_TO_RAD = DEG_TO_RAD / 1000.0f;
-    float gx = payload.xGyro * MDEG_TO_RAD;
-    float gy = payload.yGyro * MDEG_TO_RAD;
-    float gz = payload.zGyro * MDEG_TO_RAD;
+    const Scalar DEG_TO_RAD = static_cast<Scalar>(0.017453292);
+    const Scalar MDEG_TO_RAD = DEG_TO_RAD / 1000;
+    Scalar gx = payload.xGyro * MDEG_TO_RAD;
+    Scalar gy = payload.yGyro * MDEG_TO_RAD;
+    Scalar gz = payload.zGyro * MDEG_TO_RAD;
     
     // Local copies of acceleration and magnetometer data
-    float ax = payload.xAcc;
-    float ay = payload.yAcc;
-    float az = payload.zAcc;
-    float mx = payload.xMag;
-    float my = payload.yMag;
-    float mz = payload.zMag;
+    Scalar ax = payload.xAcc;
+    Scalar ay = payload.yAcc;
+    Scalar az = payload.zAcc;
+    Scalar mx = payload.xMag;
+    Scalar my = payload.yMag;
+    Scalar mz = payload.zMag;
 
     // Rate of change of quaternion from gyroscope
-    qDot1 = 0.5f * (-mQuat[1] * gx - mQuat[2] * gy - mQuat[3] * gz);
-    qDot2 = 0.5f * (mQuat[0] * gx + mQuat[2] * gz - mQuat[3] * gy);
-    qDot3 = 0.5f * (mQuat[0] * gy - mQuat[1] * gz + mQuat[3] * gx);
-    qDot4 = 0.5f * (mQuat[0] * gz + mQuat[1] * gy - mQuat[2] * gx);
+    qDot1 = 0.5f * (-mQ[1] * gx - mQ[2] * gy - mQ[3] * gz);
+    qDot2 = 0.5f * (mQ[0] * gx + mQ[2] * gz - mQ[3] * gy);
+    qDot3 = 0.5f * (mQ[0] * gy - mQ[1] * gz + mQ[3] * gx);
+    qDot4 = 0.5f * (mQ[0] * gz + mQ[1] * gy - mQ[2] * gx);
 
     // Compute feedback only if accelerometer measurement valid (avoids NaN in accelerometer normalisation)
     if(!((ax == 0.0f) && (ay == 0.0f) && (az == 0.0f)))
@@ -53,40 +175,40 @@ void MadgwickAHRS::update(const Payload_IMU_t& payload)
         mz *= recipNorm;
 
         // Auxiliary variables to avoid repeated arithmetic
-        _2q0mx = 2.0f * mQuat[0] * mx;
-        _2q0my = 2.0f * mQuat[0] * my;
-        _2q0mz = 2.0f * mQuat[0] * mz;
-        _2q1mx = 2.0f * mQuat[1] * mx;
-        _2q0 = 2.0f * mQuat[0];
-        _2q1 = 2.0f * mQuat[1];
-        _2q2 = 2.0f * mQuat[2];
-        _2q3 = 2.0f * mQuat[3];
-        _2q0q2 = 2.0f * mQuat[0] * mQuat[2];
-        _2q2q3 = 2.0f * mQuat[2] * mQuat[3];
-        q0q0 = mQuat[0] * mQuat[0];
-        q0q1 = mQuat[0] * mQuat[1];
-        q0q2 = mQuat[0] * mQuat[2];
-        q0q3 = mQuat[0] * mQuat[3];
-        q1q1 = mQuat[1] * mQuat[1];
-        q1q2 = mQuat[1] * mQuat[2];
-        q1q3 = mQuat[1] * mQuat[3];
-        q2q2 = mQuat[2] * mQuat[2];
-        q2q3 = mQuat[2] * mQuat[3];
-        q3q3 = mQuat[3] * mQuat[3];
+        _2q0mx = 2.0f * mQ[0] * mx;
+        _2q0my = 2.0f * mQ[0] * my;
+        _2q0mz = 2.0f * mQ[0] * mz;
+        _2q1mx = 2.0f * mQ[1] * mx;
+        _2q0 = 2.0f * mQ[0];
+        _2q1 = 2.0f * mQ[1];
+        _2q2 = 2.0f * mQ[2];
+        _2q3 = 2.0f * mQ[3];
+        _2q0q2 = 2.0f * mQ[0] * mQ[2];
+        _2q2q3 = 2.0f * mQ[2] * mQ[3];
+        q0q0 = mQ[0] * mQ[0];
+        q0q1 = mQ[0] * mQ[1];
+        q0q2 = mQ[0] * mQ[2];
+        q0q3 = mQ[0] * mQ[3];
+        q1q1 = mQ[1] * mQ[1];
+        q1q2 = mQ[1] * mQ[2];
+        q1q3 = mQ[1] * mQ[3];
+        q2q2 = mQ[2] * mQ[2];
+        q2q3 = mQ[2] * mQ[3];
+        q3q3 = mQ[3] * mQ[3];
 
         // Reference direction of Earth's magnetic field
-        hx = mx * q0q0 - _2q0my * mQuat[3] + _2q0mz * mQuat[2] + mx * q1q1 + _2q1 * my * mQuat[2] + _2q1 * mz * mQuat[3] - mx * q2q2 - mx * q3q3;
-        hy = _2q0mx * mQuat[3] + my * q0q0 - _2q0mz * mQuat[1] + _2q1mx * mQuat[2] - my * q1q1 + my * q2q2 + _2q2 * mz * mQuat[3] - my * q3q3;
-        _2bx = sqrt(hx * hx + hy * hy);
-        _2bz = -_2q0mx * mQuat[2] + _2q0my * mQuat[1] + mz * q0q0 + _2q1mx * mQuat[3] - mz * q1q1 + _2q2 * my * mQuat[3] - mz * q2q2 + mz * q3q3;
+        hx = mx * q0q0 - _2q0my * mQ[3] + _2q0mz * mQ[2] + mx * q1q1 + _2q1 * my * mQ[2] + _2q1 * mz * mQ[3] - mx * q2q2 - mx * q3q3;
+        hy = _2q0mx * mQ[3] + my * q0q0 - _2q0mz * mQ[1] + _2q1mx * mQ[2] - my * q1q1 + my * q2q2 + _2q2 * mz * mQ[3] - my * q3q3;
+        _2bx = std::sqrt(hx * hx + hy * hy);
+        _2bz = -_2q0mx * mQ[2] + _2q0my * mQ[1] + mz * q0q0 + _2q1mx * mQ[3] - mz * q1q1 + _2q2 * my * mQ[3] - mz * q2q2 + mz * q3q3;
         _4bx = 2.0f * _2bx;
         _4bz = 2.0f * _2bz;
 
         // Gradient decent algorithm corrective step
-        s0 = -_2q2 * (2.0f * q1q3 - _2q0q2 - ax) + _2q1 * (2.0f * q0q1 + _2q2q3 - ay) - _2bz * mQuat[2] * (_2bx * (0.5f - q2q2 - q3q3) + _2bz * (q1q3 - q0q2) - mx) + (-_2bx * mQuat[3] + _2bz * mQuat[1]) * (_2bx * (q1q2 - q0q3) + _2bz * (q0q1 + q2q3) - my) + _2bx * mQuat[2] * (_2bx * (q0q2 + q1q3) + _2bz * (0.5f - q1q1 - q2q2) - mz);
-        s1 = _2q3 * (2.0f * q1q3 - _2q0q2 - ax) + _2q0 * (2.0f * q0q1 + _2q2q3 - ay) - 4.0f * mQuat[1] * (1 - 2.0f * q1q1 - 2.0f * q2q2 - az) + _2bz * mQuat[3] * (_2bx * (0.5f - q2q2 - q3q3) + _2bz * (q1q3 - q0q2) - mx) + (_2bx * mQuat[2] + _2bz * mQuat[0]) * (_2bx * (q1q2 - q0q3) + _2bz * (q0q1 + q2q3) - my) + (_2bx * mQuat[3] - _4bz * mQuat[1]) * (_2bx * (q0q2 + q1q3) + _2bz * (0.5f - q1q1 - q2q2) - mz);
-        s2 = -_2q0 * (2.0f * q1q3 - _2q0q2 - ax) + _2q3 * (2.0f * q0q1 + _2q2q3 - ay) - 4.0f * mQuat[2] * (1 - 2.0f * q1q1 - 2.0f * q2q2 - az) + (-_4bx * mQuat[2] - _2bz * mQuat[0]) * (_2bx * (0.5f - q2q2 - q3q3) + _2bz * (q1q3 - q0q2) - mx) + (_2bx * mQuat[1] + _2bz * mQuat[3]) * (_2bx * (q1q2 - q0q3) + _2bz * (q0q1 + q2q3) - my) + (_2bx * mQuat[0] - _4bz * mQuat[2]) * (_2bx * (q0q2 + q1q3) + _2bz * (0.5f - q1q1 - q2q2) - mz);
-        s3 = _2q1 * (2.0f * q1q3 - _2q0q2 - ax) + _2q2 * (2.0f * q0q1 + _2q2q3 - ay) + (-_4bx * mQuat[3] + _2bz * mQuat[1]) * (_2bx * (0.5f - q2q2 - q3q3) + _2bz * (q1q3 - q0q2) - mx) + (-_2bx * mQuat[0] + _2bz * mQuat[2]) * (_2bx * (q1q2 - q0q3) + _2bz * (q0q1 + q2q3) - my) + _2bx * mQuat[1] * (_2bx * (q0q2 + q1q3) + _2bz * (0.5f - q1q1 - q2q2) - mz);
+        s0 = -_2q2 * (2.0f * q1q3 - _2q0q2 - ax) + _2q1 * (2.0f * q0q1 + _2q2q3 - ay) - _2bz * mQ[2] * (_2bx * (0.5f - q2q2 - q3q3) + _2bz * (q1q3 - q0q2) - mx) + (-_2bx * mQ[3] + _2bz * mQ[1]) * (_2bx * (q1q2 - q0q3) + _2bz * (q0q1 + q2q3) - my) + _2bx * mQ[2] * (_2bx * (q0q2 + q1q3) + _2bz * (0.5f - q1q1 - q2q2) - mz);
+        s1 = _2q3 * (2.0f * q1q3 - _2q0q2 - ax) + _2q0 * (2.0f * q0q1 + _2q2q3 - ay) - 4.0f * mQ[1] * (1 - 2.0f * q1q1 - 2.0f * q2q2 - az) + _2bz * mQ[3] * (_2bx * (0.5f - q2q2 - q3q3) + _2bz * (q1q3 - q0q2) - mx) + (_2bx * mQ[2] + _2bz * mQ[0]) * (_2bx * (q1q2 - q0q3) + _2bz * (q0q1 + q2q3) - my) + (_2bx * mQ[3] - _4bz * mQ[1]) * (_2bx * (q0q2 + q1q3) + _2bz * (0.5f - q1q1 - q2q2) - mz);
+        s2 = -_2q0 * (2.0f * q1q3 - _2q0q2 - ax) + _2q3 * (2.0f * q0q1 + _2q2q3 - ay) - 4.0f * mQ[2] * (1 - 2.0f * q1q1 - 2.0f * q2q2 - az) + (-_4bx * mQ[2] - _2bz * mQ[0]) * (_2bx * (0.5f - q2q2 - q3q3) + _2bz * (q1q3 - q0q2) - mx) + (_2bx * mQ[1] + _2bz * mQ[3]) * (_2bx * (q1q2 - q0q3) + _2bz * (q0q1 + q2q3) - my) + (_2bx * mQ[0] - _4bz * mQ[2]) * (_2bx * (q0q2 + q1q3) + _2bz * (0.5f - q1q1 - q2q2) - mz);
+        s3 = _2q1 * (2.0f * q1q3 - _2q0q2 - ax) + _2q2 * (2.0f * q0q1 + _2q2q3 - ay) + (-_4bx * mQ[3] + _2bz * mQ[1]) * (_2bx * (0.5f - q2q2 - q3q3) + _2bz * (q1q3 - q0q2) - mx) + (-_2bx * mQ[0] + _2bz * mQ[2]) * (_2bx * (q1q2 - q0q3) + _2bz * (q0q1 + q2q3) - my) + _2bx * mQ[1] * (_2bx * (q0q2 + q1q3) + _2bz * (0.5f - q1q1 - q2q2) - mz);
         recipNorm = invSqrt(s0 * s0 + s1 * s1 + s2 * s2 + s3 * s3); // normalise step magnitude
         s0 *= recipNorm;
         s1 *= recipNorm;
@@ -94,25 +216,35 @@ void MadgwickAHRS::update(const Payload_IMU_t& payload)
         s3 *= recipNorm;
 
         // Apply feedback step
-        qDot1 -= mBeta * s0;
-        qDot2 -= mBeta * s1;
-        qDot3 -= mBeta * s2;
-        qDot4 -= mBeta * s3;
+        qDot1 -= BETA * s0;
+        qDot2 -= BETA * s1;
+        qDot3 -= BETA * s2;
+        qDot4 -= BETA * s3;
     }
 
-    // Integrate rate of change of quaternion to yield quaternion
-    mQuat[0] += qDot1 * mUpdatePeriod;
-    mQuat[1] += qDot2 * mUpdatePeriod;
-    mQuat[2] += qDot3 * mUpdatePeriod;
-    mQuat[3] += qDot4 * mUpdatePeriod;
+    integrate(qDot1, qDot2, qDot3, qDot4, payload);
+}
+
+template <typename Beta, SensorSet SENSORS, typename Scalar>
+inline void MadgwickAHRS<Beta, SENSORS, Scalar>::integrate(const Scalar qDot1, const Scalar qDot2, const Scalar qDot3,
+                                                           const Scalar qDot4, const Payload_IMU_t& payload)
+{
+    // Integrate rate of change of quaternion over the time covered by the sample
+    const Scalar period = samplePeriod(payload);
+    mQ[0] += qDot1 * period;
+    mQ[1] += qDot2 * period;
+    mQ[2] += qDot3 * period;
+    mQ[3] += qDot4 * period;
 
     // Normalise quaternion
-    recipNorm = invSqrt(mQuat[0] * mQuat[0] + mQuat[1] * mQuat[1] + mQuat[2] * mQuat[2] + mQuat[3] * mQuat[3]);
-    mQuat[0] *= recipNorm;
-    mQuat[1] *= recipNorm;
-    mQuat[2] *= recipNorm;
-    mQuat[3] *= recipNorm;
-
-    // Update Euler angles
-    quatToAngles();
-} 
\ No newline at end of file
+    const Scalar recipNorm = invSqrt(mQ[0] * mQ[0] + mQ[1] * mQ[1] + mQ[2] * mQ[2] + mQ[3] * mQ[3]);
+    mQ[0] *= recipNorm;
+    mQ[1] *= recipNorm;
+    mQ[2] *= recipNorm;
+    mQ[3] *= recipNorm;
+}
+
+template class MadgwickAHRS<MadgwickDefaultBeta, SensorSet::GYRO_ACCEL, float>;
+template class MadgwickAHRS<MadgwickDefaultBeta, SensorSet::GYRO_ACCEL_MAG, float>;
+template class MadgwickAHRS<MadgwickDefaultBeta, SensorSet::GYRO_ACCEL, double>;
+template class MadgwickAHRS<MadgwickDefaultBeta, SensorSet::GYRO_ACCEL_MAG, double>;
@@ -1,16 +1,41 @@
 #pragma once
 
+#include <ratio>
 #include "ahrs/AHRS.h"
+#include "core/SensorSet.h"
+
+/** Algorithm gain of the shipped Madgwick filters */
+typedef std::ratio<1, 10> MadgwickDefaultBeta;
 
 /**
  * @brief Madgwick AHRS algorithm implementation
  * 
  * Implementation of Madgwick's IMU and AHRS algorithms.
  * See: http://www.x-io.co.uk/node/8#open_source_ahrs_and_imu_algorithms
+ * 
+ * The gain, the sensors and the scalar type are template parameters, so each
+ * instantiation folds its constants and carries no code for absent sensors.
+ * With SensorSet::GYRO_ACCEL every sample runs the 6-axis (IMU) step. With
+ * SensorSet::GYRO_ACCEL_MAG a sample runs the 9-axis (MARG) step when it
+ * carries a new magnetometer measurement, and the 6-axis step when the field
+ * is a zero vector or repeats the previous one exactly. A fresh reading of a
+ * noisy sensor always differs in some bit, whereas millisecond timestamps
+ * collide above 1 kHz and cannot tell a repeated reading apart.
+ * 
+ * The member functions are defined in MadgwickAHRS.cpp, which instantiates
+ * the shipped configurations.
+ * 
+ * @tparam Beta Algorithm gain, as a std::ratio
+ * @tparam SENSORS Sensors fused by the filter
+ * @tparam Scalar Type of the state and of the arithmetic, float or double
  */
-class MadgwickAHRS : public AHRS
+template <typename Beta = MadgwickDefaultBeta, SensorSet SENSORS = SensorSet::GYRO_ACCEL_MAG, typename Scalar = float>
+class MadgwickAHRS final : public AHRS
 {
 public:
+    /** Algorithm gain */
+    static constexpr Scalar BETA = static_cast<Scalar>(Beta::num) / static_cast<Scalar>(Beta::den);
+
     /**
      * @brief Constructor
      * 
@@ -24,8 +49,60 @@ public:
      * @param payload The IMU payload data
      */
     void update(const Payload_IMU_t& payload) override;
+
+    /**
+     * @brief Process consecutive IMU samples using Madgwick algorithm
+     * 
+     * @param samples The IMU samples, oldest first
+     * @param count Number of samples
+     */
+    void update(const Payload_IMU_t* samples, const size_t count) override;
     
 private:
-    // Algorithm parameters
-    float mBeta; ///< Algorithm gain
-}; 
\ No newline at end of file
+    /**
+     * @brief Advance the filter by one sample, leaving mQuat stale
+     * 
+     * @param payload The IMU payload data
+     */
+    void step(const Payload_IMU_t& payload);
+
+    /**
+     * @brief Advance the filter by one sample from the gyroscope and accelerometer only
+     * 
+     * @param payload The IMU payload data
+     */
+    void stepIMU(const Payload_IMU_t& payload);
+
+    /**
+     * @brief Advance the filter by one sample from the gyroscope, accelerometer and magnetometer
+     * 
+     * @param payload The IMU payload data
+     */
+    void stepMARG(const Payload_IMU_t& payload);
+
+    /**
+     * @brief Integrate the rate of change of the quaternion over the sample period and normalise it
+     * 
+     * @param qDot1 Rate of change of w
+     * @param qDot2 Rate of change of x
+     * @param qDot3 Rate of change of y
+     * @param qDot4 Rate of change of z
+     * @param payload The IMU payload data, for its timestamps
+     */
+    void integrate(const Scalar qDot1, const Scalar qDot2, const Scalar qDot3, const Scalar qDot4,
+                   const Payload_IMU_t& payload);
+
+    /**
+     * @brief Copy the state to the float quaternion of the interface and mark the Euler angles stale
+     */
+    void publish();
+
+    Scalar mQ[4];              ///< Quaternion [w, x, y, z] the filter works on
+    float mLastMag[3];         ///< Magnetometer field of the previous sample, zero before the first one
+};
+
+// Configurations instantiated by MadgwickAHRS.cpp
+extern template class MadgwickAHRS<MadgwickDefaultBeta, SensorSet::GYRO_ACCEL, float>;
+extern template class MadgwickAHRS<MadgwickDefaultBeta, SensorSet::GYRO_ACCEL_MAG, float>;
+extern template class MadgwickAHRS<MadgwickDefaultBeta, SensorSet::GYRO_ACCEL, double>;
+extern template class MadgwickAHRS<MadgwickDefaultBeta, SensorSet::GYRO_ACCEL_MAG, double>;
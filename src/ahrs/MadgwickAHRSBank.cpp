@@ -0,0 +1,234 @@
+#include <cstdlib>
+#include <cstring>
+#include <new>
+#include <spdlog/spdlog.h>
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+#include "ahrs/MadgwickAHRSBank.h"
+#include "core/PayloadIMU.h"
+
+namespace
+{
+/** Number of arrays per bank: the quaternion components, the nine inputs then the periods */
+inline constexpr size_t ARRAY_COUNT = 14;
+inline constexpr size_t CACHE_LINE_BYTES = 64;
+inline constexpr float MADGWICK_BETA = 0.1f;
+
+/**
+ * @brief One stream at a time, the fallback of every other kernel
+ */
+struct ScalarOps
+{
+    typedef float V;
+    static constexpr size_t WIDTH = 1;
+
+    static inline V load(const float* src) { return *src; }
+    static inline void store(float* dst, const V value) { *dst = value; }
+    static inline V set1(const float value) { return value; }
+    static inline V select(const bool mask, const V a, const V b) { return mask ? a : b; }
+    static inline V sqrt(const V value) { return __builtin_sqrtf(value); }
+};
+
+void madgwickBankStepScalar(const MadgwickBankArrays& arrays, const size_t count)
+{
+    madgwickBankStep<ScalarOps>(arrays, count);
+}
+
+#if defined(__SSE2__)
+/**
+ * @brief 4 streams per instruction, part of the x86-64 baseline
+ */
+struct SSEOps : MadgwickBankVectorOps<16>
+{
+    static inline V sqrt(const V value) { return _mm_sqrt_ps(value); }
+};
+
+void madgwickBankStepSSE(const MadgwickBankArrays& arrays, const size_t count)
+{
+    madgwickBankStep<SSEOps>(arrays, count);
+}
+#endif
+} // end of anonymous namespace
+
+MadgwickAHRSBank::MadgwickAHRSBank(const size_t streamCount, const float updateFrequencyHz, const Kernel kernel)
+    : mStreamCount(streamCount)
+    , mPaddedCount((streamCount + MAX_LANES - 1) / MAX_LANES * MAX_LANES)
+    , mKernel(Kernel::SCALAR)
+    , mStep(&madgwickBankStepScalar)
+    , mStorage(nullptr)
+    , mArrays()
+    , mInputs()
+    , mPeriods(nullptr)
+    , mClocks(streamCount, SampleClock(updateFrequencyHz))
+    , mLastMag(3 * streamCount, 0.0f)
+{
+    // Every array starts on its own cache line, padding lanes stay at rest with null inputs
+    const size_t bytes = ARRAY_COUNT * mPaddedCount * sizeof(float);
+    mStorage.reset(static_cast<float*>(aligned_alloc(CACHE_LINE_BYTES, bytes > 0 ? bytes : CACHE_LINE_BYTES)));
+    if (!mStorage)
+    {
+        throw std::bad_alloc();
+    }
+    memset(mStorage.get(), 0, bytes);
+
+    float* arrays[ARRAY_COUNT];
+    for (size_t i = 0; i < ARRAY_COUNT; ++i)
+    {
+        arrays[i] = mStorage.get() + i * mPaddedCount;
+    }
+    for (size_t lane = 0; lane < mPaddedCount; ++lane)
+    {
+        arrays[0][lane] = 1.0f;
+    }
+    mArrays.q0 = arrays[0];
+    mArrays.q1 = arrays[1];
+    mArrays.q2 = arrays[2];
+    mArrays.q3 = arrays[3];
+    mArrays.gx = mInputs[0] = arrays[4];
+    mArrays.gy = mInputs[1] = arrays[5];
+    mArrays.gz = mInputs[2] = arrays[6];
+    mArrays.ax = mInputs[3] = arrays[7];
+    mArrays.ay = mInputs[4] = arrays[8];
+    mArrays.az = mInputs[5] = arrays[9];
+    mArrays.mx = mInputs[6] = arrays[10];
+    mArrays.my = mInputs[7] = arrays[11];
+    mArrays.mz = mInputs[8] = arrays[12];
+    mArrays.period = mPeriods = arrays[13];
+    mArrays.beta = MADGWICK_BETA;
+
+    // Widest supported kernel first, unless a specific one was asked for and is available
+    Kernel selected = kernel;
+    if (kernel != Kernel::AUTO && !isSupported(kernel))
+    {
+        spdlog::warn("AHRS bank kernel {} is not supported on this CPU", getKernelName(kernel));
+        selected = Kernel::AUTO;
+    }
+    if (selected == Kernel::AUTO)
+    {
+        for (Kernel candidate : {Kernel::AVX512, Kernel::AVX2, Kernel::SSE, Kernel::SCALAR})
+        {
+            if (isSupported(candidate))
+            {
+                selected = candidate;
+                break;
+            }
+        }
+    }
+
+    mKernel = selected;
+    switch (selected)
+    {
+#if defined(AHRS_BANK_X86_KERNELS)
+        case Kernel::AVX512:
+            mStep = &madgwickBankStepAVX512;
+            break;
+        case Kernel::AVX2:
+            mStep = &madgwickBankStepAVX2;
+            break;
+#endif
+#if defined(__SSE2__)
+        case Kernel::SSE:
+            mStep = &madgwickBankStepSSE;
+            break;
+#endif
+        default:
+            mKernel = Kernel::SCALAR;
+            mStep = &madgwickBankStepScalar;
+            break;
+    }
+    spdlog::debug("AHRS bank of {} streams uses the {} kernel", mStreamCount, getKernelName(mKernel));
+}
+
+bool MadgwickAHRSBank::isSupported(const Kernel kernel)
+{
+    switch (kernel)
+    {
+        case Kernel::SCALAR:
+            return true;
+#if defined(__SSE2__)
+        case Kernel::SSE:
+            return true;
+#endif
+#if defined(AHRS_BANK_X86_KERNELS)
+        case Kernel::AVX2:
+            __builtin_cpu_init();
+            return __builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma");
+        case Kernel::AVX512:
+            __builtin_cpu_init();
+            return __builtin_cpu_supports("avx512f");
+#endif
+        default:
+            return false;
+    }
+}
+
+const char* MadgwickAHRSBank::getKernelName(const Kernel kernel)
+{
+    switch (kernel)
+    {
+        case Kernel::AUTO:
+            return "auto";
+        case Kernel::SCALAR:
+            return "scalar";
+        case Kernel::SSE:
+            return "sse";
+        case Kernel::AVX2:
+            return "avx2";
+        case Kernel::AVX512:
+            return "avx512";
+        default:
+            return "unknown";
+    }
+}
+
+void MadgwickAHRSBank::setSample(const size_t stream, const Payload_IMU_t& payload)
+{
+    // Convert gyro data from mdeg/s to rad/s
+    const float DEG_TO_RAD = 0.017453292f;
+    const float MDEG_TO_RAD = DEG_TO_RAD / 1000.0f;
+    mInputs[0][stream] = payload.xGyro * MDEG_TO_RAD;
+    mInputs[1][stream] = payload.yGyro * MDEG_TO_RAD;
+    mInputs[2][stream] = payload.zGyro * MDEG_TO_RAD;
+    mInputs[3][stream] = payload.xAcc;
+    mInputs[4][stream] = payload.yAcc;
+    mInputs[5][stream] = payload.zAcc;
+    mPeriods[stream] = mClocks[stream].period(payload);
+
+    // A null field takes the 6-axis step in the kernels
+    float* lastMag = &mLastMag[3 * stream];
+    const bool magStale = payload.xMag == lastMag[0] && payload.yMag == lastMag[1] && payload.zMag == lastMag[2];
+    lastMag[0] = payload.xMag;
+    lastMag[1] = payload.yMag;
+    lastMag[2] = payload.zMag;
+    mInputs[6][stream] = magStale ? 0.0f : payload.xMag;
+    mInputs[7][stream] = magStale ? 0.0f : payload.yMag;
+    mInputs[8][stream] = magStale ? 0.0f : payload.zMag;
+}
+
+void MadgwickAHRSBank::update()
+{
+    mStep(mArrays, mPaddedCount);
+}
+
+void MadgwickAHRSBank::update(const Payload_IMU_t* samples)
+{
+    for (size_t stream = 0; stream < mStreamCount; ++stream)
+    {
+        setSample(stream, samples[stream]);
+    }
+    update();
+}
+
+void MadgwickAHRSBank::getQuaternion(const size_t stream, float quat[4]) const
+{
+    quat[0] = mArrays.q0[stream];
+    quat[1] = mArrays.q1[stream];
+    quat[2] = mArrays.q2[stream];
+    quat[3] = mArrays.q3[stream];
+}
+
+void MadgwickAHRSBank::FreeDeleter::operator()(float* storage) const
+{
+    free(storage);
+}
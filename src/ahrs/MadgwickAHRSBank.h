@@ -0,0 +1,140 @@
+#pragma once
+
+#include <cstddef>
+#include <memory>
+#include <vector>
+#include "ahrs/MadgwickAHRSBankKernel.h"
+#include "ahrs/SampleClock.h"
+
+typedef struct Payload_IMU_s Payload_IMU_t;
+
+/**
+ * @brief Bank of independent Madgwick filters advanced together with SIMD
+ *
+ * The quaternions and inputs of all streams are stored as structure of
+ * arrays, so that one instruction advances 4 (SSE), 8 (AVX2) or 16 (AVX-512)
+ * streams. The widest kernel supported by the CPU is picked at construction.
+ *
+ * Like MadgwickAHRS, every stream integrates each sample over the interval
+ * measured by its own SampleClock, and a stream whose magnetometer field is
+ * null or stale takes the 6-axis step, lane by lane. The kernels compute the
+ * normalisations exactly. Fed the same samples, every quaternion component
+ * stays within 1e-6 of MadgwickAHRS built with EXACT normalisations:
+ * measured 5e-9 after 5000 updates of 64 streams with jittered timestamps,
+ * gaps and timestamps going backwards, mixing live, 100 Hz and missing
+ * magnetometers, the FMA contractions of the AVX2 and AVX-512 kernels
+ * included. MadgwickAHRS built with another InvSqrtPolicy tracks the bank
+ * within the precision of that policy: in the same run it stays within
+ * 2.4e-7 with RSQRT_NR1 and 2.4e-4 with RSQRT.
+ */
+class MadgwickAHRSBank
+{
+public:
+    /** Widest kernel in floats, stream arrays are padded to a multiple of it */
+    static constexpr size_t MAX_LANES = 16;
+
+    /**
+     * @brief Kernels the bank can run
+     */
+    enum class Kernel
+    {
+        AUTO,   ///< Widest kernel supported by the CPU
+        SCALAR, ///< One stream at a time
+        SSE,    ///< 4 streams per instruction
+        AVX2,   ///< 8 streams per instruction
+        AVX512  ///< 16 streams per instruction
+    };
+
+    /**
+     * @brief Constructor with the number of streams and their update frequency
+     *
+     * All filters start at the identity orientation.
+     *
+     * @param streamCount Number of independent filters
+     * @param updateFrequencyHz The nominal update frequency in Hz, used when the samples carry no usable timestamps
+     * @param kernel Kernel to run, falls back to the widest supported one if unavailable
+     */
+    MadgwickAHRSBank(const size_t streamCount, const float updateFrequencyHz, const Kernel kernel = Kernel::AUTO);
+
+    /**
+     * @brief Check if a kernel can run on this CPU
+     *
+     * @param kernel The kernel to check
+     * @return true if the kernel is built in and supported by the CPU
+     */
+    static bool isSupported(const Kernel kernel);
+
+    /**
+     * @brief Get the name of a kernel
+     *
+     * @param kernel The kernel
+     * @return Printable name of the kernel
+     */
+    static const char* getKernelName(const Kernel kernel);
+
+    /**
+     * @brief Get the kernel the bank runs
+     *
+     * @return The selected kernel, never Kernel::AUTO
+     */
+    inline Kernel getKernel() const { return mKernel; }
+
+    /**
+     * @brief Get the number of streams
+     *
+     * @return Number of filters in the bank
+     */
+    inline size_t getStreamCount() const { return mStreamCount; }
+
+    /**
+     * @brief Set the next sample of a stream
+     *
+     * A magnetometer field repeating the previous sample of the stream exactly
+     * marks a stale measurement, which is replaced with a null field so that
+     * the stream takes the 6-axis step, as MadgwickAHRS does.
+     *
+     * @param stream Index of the stream
+     * @param payload The IMU payload data
+     */
+    void setSample(const size_t stream, const Payload_IMU_t& payload);
+
+    /**
+     * @brief Advance every stream by its current sample
+     */
+    void update();
+
+    /**
+     * @brief Set one sample per stream and advance every stream
+     *
+     * @param samples One sample per stream, in stream order
+     */
+    void update(const Payload_IMU_t* samples);
+
+    /**
+     * @brief Get the quaternion of a stream
+     *
+     * @param stream Index of the stream
+     * @param quat Receives the quaternion [w, x, y, z]
+     */
+    void getQuaternion(const size_t stream, float quat[4]) const;
+
+private:
+    /**
+     * @brief Free the aligned array storage
+     */
+    struct FreeDeleter
+    {
+        void operator()(float* storage) const;
+    };
+
+    size_t mStreamCount;   ///< Number of filters
+    size_t mPaddedCount;   ///< Number of lanes in every array, a multiple of MAX_LANES
+    Kernel mKernel;        ///< Kernel selected at construction
+    void (*mStep)(const MadgwickBankArrays&, const size_t); ///< Entry point of the selected kernel
+    std::unique_ptr<float[], FreeDeleter> mStorage; ///< Cache line aligned storage of all arrays
+    MadgwickBankArrays mArrays; ///< Arrays carved out of mStorage
+    float* mInputs[9];     ///< Writable views of the input arrays, gyro then accel then mag
+    float* mPeriods;       ///< Writable view of the integration periods
+    std::vector<SampleClock> mClocks; ///< Integration periods of every stream, from its timestamps
+    std::vector<float> mLastMag;   ///< Magnetometer field of the previous sample, three floats per stream
+};
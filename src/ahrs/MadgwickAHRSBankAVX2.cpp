@@ -0,0 +1,18 @@
+#include <immintrin.h>
+#include "ahrs/MadgwickAHRSBankKernel.h"
+
+namespace
+{
+/**
+ * @brief 8 streams per instruction, built with -mavx2 -mfma
+ */
+struct AVX2Ops : MadgwickBankVectorOps<32>
+{
+    static inline V sqrt(const V value) { return _mm256_sqrt_ps(value); }
+};
+} // end of anonymous namespace
+
+void madgwickBankStepAVX2(const MadgwickBankArrays& arrays, const size_t count)
+{
+    madgwickBankStep<AVX2Ops>(arrays, count);
+}
@@ -0,0 +1,20 @@
+#include <immintrin.h>
+#include "ahrs/MadgwickAHRSBankKernel.h"
+
+namespace
+{
+/**
+ * @brief 16 streams per instruction, built with -mavx512f
+ */
+struct AVX512Ops : MadgwickBankVectorOps<64>
+{
+    // Merging into the input under a full mask is plain vsqrtps, without the undefined source of
+    // _mm512_sqrt_ps() that GCC reports as maybe-uninitialized
+    static inline V sqrt(const V value) { return _mm512_mask_sqrt_ps(value, 0xFFFF, value); }
+};
+} // end of anonymous namespace
+
+void madgwickBankStepAVX512(const MadgwickBankArrays& arrays, const size_t count)
+{
+    madgwickBankStep<AVX512Ops>(arrays, count);
+}
@@ -0,0 +1,202 @@
+#pragma once
+
+#include <cstddef>
+#include <cstring>
+
+/**
+ * @brief Structure-of-arrays view of the state and inputs of a bank of Madgwick filters
+ *
+ * Every array holds one value per stream and is padded to a multiple of
+ * MadgwickAHRSBank::MAX_LANES, so kernels never need a scalar tail.
+ */
+struct MadgwickBankArrays
+{
+    float* q0;       ///< Quaternion w of every stream
+    float* q1;       ///< Quaternion x of every stream
+    float* q2;       ///< Quaternion y of every stream
+    float* q3;       ///< Quaternion z of every stream
+    const float* gx; ///< Gyro x in rad/s
+    const float* gy; ///< Gyro y in rad/s
+    const float* gz; ///< Gyro z in rad/s
+    const float* ax; ///< Acceleration x
+    const float* ay; ///< Acceleration y
+    const float* az; ///< Acceleration z
+    const float* mx; ///< Magnetic induction x
+    const float* my; ///< Magnetic induction y
+    const float* mz; ///< Magnetic induction z
+    const float* period; ///< Integration period of the sample in seconds
+    float beta;      ///< Algorithm gain
+};
+
+/**
+ * @brief Advance streams [0, count) of a bank by one sample
+ *
+ * The body is the scalar MadgwickAHRS step, 9-axis and 6-axis, written once
+ * against a lane type.
+ * Each instruction set instantiates it in its own translation unit with its
+ * own compiler flags, through an Ops class providing:
+ * - V: the lane type, float or a GCC vector of floats
+ * - WIDTH: number of streams per V
+ * - load(), store(), set1(), sqrt()
+ * - select(mask, a, b): a where mask is set, b elsewhere
+ *
+ * @param arrays The bank state and inputs
+ * @param count Number of streams to advance, a multiple of Ops::WIDTH
+ */
+template <typename Ops>
+inline void madgwickBankStep(const MadgwickBankArrays& arrays, const size_t count)
+{
+    using V = typename Ops::V;
+    const V zero = Ops::set1(0.0f);
+    const V half = Ops::set1(0.5f);
+    const V one = Ops::set1(1.0f);
+    const V two = Ops::set1(2.0f);
+    const V four = Ops::set1(4.0f);
+    const V beta = Ops::set1(arrays.beta);
+
+    for (size_t i = 0; i < count; i += Ops::WIDTH)
+    {
+        V q0 = Ops::load(arrays.q0 + i);
+        V q1 = Ops::load(arrays.q1 + i);
+        V q2 = Ops::load(arrays.q2 + i);
+        V q3 = Ops::load(arrays.q3 + i);
+        const V gx = Ops::load(arrays.gx + i);
+        const V gy = Ops::load(arrays.gy + i);
+        const V gz = Ops::load(arrays.gz + i);
+        V ax = Ops::load(arrays.ax + i);
+        V ay = Ops::load(arrays.ay + i);
+        V az = Ops::load(arrays.az + i);
+        V mx = Ops::load(arrays.mx + i);
+        V my = Ops::load(arrays.my + i);
+        V mz = Ops::load(arrays.mz + i);
+        const V period = Ops::load(arrays.period + i);
+
+        // Rate of change of quaternion from gyroscope
+        V qDot1 = half * (-q1 * gx - q2 * gy - q3 * gz);
+        V qDot2 = half * (q0 * gx + q2 * gz - q3 * gy);
+        V qDot3 = half * (q0 * gy - q1 * gz + q3 * gx);
+        V qDot4 = half * (q0 * gz + q1 * gy - q2 * gx);
+
+        // Lanes with a null accelerometer measurement skip the feedback, as the scalar filter does.
+        // Their normalisations are computed on a harmless 1 instead to keep NaNs out of the lane
+        const auto valid = (ax != zero) | (ay != zero) | (az != zero);
+        V recipNorm = one / Ops::sqrt(Ops::select(valid, ax * ax + ay * ay + az * az, one));
+        ax *= recipNorm;
+        ay *= recipNorm;
+        az *= recipNorm;
+
+        // Lanes with a null magnetometer measurement take the gyroscope and accelerometer gradient instead,
+        // as the scalar filter does, their null field is left as is and keeps the unused MARG terms finite
+        const auto magValid = valid & ((mx != zero) | (my != zero) | (mz != zero));
+        recipNorm = one / Ops::sqrt(Ops::select(magValid, mx * mx + my * my + mz * mz, one));
+        mx *= recipNorm;
+        my *= recipNorm;
+        mz *= recipNorm;
+
+        // Auxiliary variables to avoid repeated arithmetic
+        const V _2q0mx = two * q0 * mx;
+        const V _2q0my = two * q0 * my;
+        const V _2q0mz = two * q0 * mz;
+        const V _2q1mx = two * q1 * mx;
+        const V _2q0 = two * q0;
+        const V _2q1 = two * q1;
+        const V _2q2 = two * q2;
+        const V _2q3 = two * q3;
+        const V _2q0q2 = two * q0 * q2;
+        const V _2q2q3 = two * q2 * q3;
+        const V q0q0 = q0 * q0;
+        const V q0q1 = q0 * q1;
+        const V q0q2 = q0 * q2;
+        const V q0q3 = q0 * q3;
+        const V q1q1 = q1 * q1;
+        const V q1q2 = q1 * q2;
+        const V q1q3 = q1 * q3;
+        const V q2q2 = q2 * q2;
+        const V q2q3 = q2 * q3;
+        const V q3q3 = q3 * q3;
+
+        // Reference direction of Earth's magnetic field
+        const V hx = mx * q0q0 - _2q0my * q3 + _2q0mz * q2 + mx * q1q1 + _2q1 * my * q2 + _2q1 * mz * q3 - mx * q2q2 - mx * q3q3;
+        const V hy = _2q0mx * q3 + my * q0q0 - _2q0mz * q1 + _2q1mx * q2 - my * q1q1 + my * q2q2 + _2q2 * mz * q3 - my * q3q3;
+        const V _2bx = Ops::sqrt(hx * hx + hy * hy);
+        const V _2bz = -_2q0mx * q2 + _2q0my * q1 + mz * q0q0 + _2q1mx * q3 - mz * q1q1 + _2q2 * my * q3 - mz * q2q2 + mz * q3q3;
+        const V _4bx = two * _2bx;
+        const V _4bz = two * _2bz;
+
+        // Gradient decent algorithm corrective step, the residuals are shared by the four components
+        const V fAx = two * q1q3 - _2q0q2 - ax;
+        const V fAy = two * q0q1 + _2q2q3 - ay;
+        const V fAz = one - two * q1q1 - two * q2q2 - az;
+        const V fMx = _2bx * (half - q2q2 - q3q3) + _2bz * (q1q3 - q0q2) - mx;
+        const V fMy = _2bx * (q1q2 - q0q3) + _2bz * (q0q1 + q2q3) - my;
+        const V fMz = _2bx * (q0q2 + q1q3) + _2bz * (half - q1q1 - q2q2) - mz;
+        V s0 = -_2q2 * fAx + _2q1 * fAy - _2bz * q2 * fMx + (-_2bx * q3 + _2bz * q1) * fMy + _2bx * q2 * fMz;
+        V s1 = _2q3 * fAx + _2q0 * fAy - four * q1 * fAz + _2bz * q3 * fMx + (_2bx * q2 + _2bz * q0) * fMy + (_2bx * q3 - _4bz * q1) * fMz;
+        V s2 = -_2q0 * fAx + _2q3 * fAy - four * q2 * fAz + (-_4bx * q2 - _2bz * q0) * fMx + (_2bx * q1 + _2bz * q3) * fMy + (_2bx * q0 - _4bz * q2) * fMz;
+        V s3 = _2q1 * fAx + _2q2 * fAy + (-_4bx * q3 + _2bz * q1) * fMx + (-_2bx * q0 + _2bz * q2) * fMy + _2bx * q1 * fMz;
+
+        // Gradient of the accelerometer alone, the scalar stepIMU() expression
+        const V _4q0 = four * q0;
+        const V _4q1 = four * q1;
+        const V _4q2 = four * q2;
+        const V _8q1 = two * _4q1;
+        const V _8q2 = two * _4q2;
+        s0 = Ops::select(magValid, s0, _4q0 * q2q2 + _2q2 * ax + _4q0 * q1q1 - _2q1 * ay);
+        s1 = Ops::select(magValid, s1, _4q1 * q3q3 - _2q3 * ax + four * q0q0 * q1 - _2q0 * ay - _4q1 + _8q1 * q1q1 + _8q1 * q2q2 + _4q1 * az);
+        s2 = Ops::select(magValid, s2, four * q0q0 * q2 + _2q0 * ax + _4q2 * q3q3 - _2q3 * ay - _4q2 + _8q2 * q1q1 + _8q2 * q2q2 + _4q2 * az);
+        s3 = Ops::select(magValid, s3, four * q1q1 * q3 - _2q1 * ax + four * q2q2 * q3 - _2q2 * ay);
+        recipNorm = one / Ops::sqrt(Ops::select(valid, s0 * s0 + s1 * s1 + s2 * s2 + s3 * s3, one)); // normalise step magnitude
+
+        // Apply feedback step
+        const V gain = Ops::select(valid, beta * recipNorm, zero);
+        qDot1 -= gain * s0;
+        qDot2 -= gain * s1;
+        qDot3 -= gain * s2;
+        qDot4 -= gain * s3;
+
+        // Integrate rate of change of quaternion to yield quaternion
+        q0 += qDot1 * period;
+        q1 += qDot2 * period;
+        q2 += qDot3 * period;
+        q3 += qDot4 * period;
+
+        // Normalise quaternion
+        recipNorm = one / Ops::sqrt(q0 * q0 + q1 * q1 + q2 * q2 + q3 * q3);
+        Ops::store(arrays.q0 + i, q0 * recipNorm);
+        Ops::store(arrays.q1 + i, q1 * recipNorm);
+        Ops::store(arrays.q2 + i, q2 * recipNorm);
+        Ops::store(arrays.q3 + i, q3 * recipNorm);
+    }
+}
+
+/**
+ * @brief Lane operations over a GCC vector of floats
+ *
+ * Each vector width is instantiated by a single translation unit, the one
+ * compiled for the matching instruction set, which derives from it and adds
+ * a sqrt() mapped on its own instruction. Sharing a width between translation units
+ * built with different flags would let the linker pick either copy.
+ */
+template <size_t BYTES>
+struct MadgwickBankVectorOps
+{
+    typedef float V __attribute__((vector_size(BYTES)));
+    static constexpr size_t WIDTH = BYTES / sizeof(float);
+
+    static inline V load(const float* src)
+    {
+        V value;
+        memcpy(&value, src, sizeof(V));
+        return value;
+    }
+    static inline void store(float* dst, const V value) { memcpy(dst, &value, sizeof(V)); }
+    static inline V set1(const float value) { return V{} + value; }
+    template <typename M>
+    static inline V select(const M mask, const V a, const V b) { return mask ? a : b; }
+};
+
+// Kernels living in their own translation units, each built for its instruction set
+#if defined(AHRS_BANK_X86_KERNELS)
+void madgwickBankStepAVX2(const MadgwickBankArrays& arrays, const size_t count);
+void madgwickBankStepAVX512(const MadgwickBankArrays& arrays, const size_t count);
+#endif
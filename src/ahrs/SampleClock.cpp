@@ -0,0 +1,48 @@
+#include <algorithm>
+#include "ahrs/SampleClock.h"
+#include "core/PayloadIMU.h"
+
+SampleClock::SampleClock(const float updateFrequencyHz)
+    : mNominalPeriod(1.0f / updateFrequencyHz)
+    , mMaxSampleGapNs(std::max(MIN_SAMPLE_GAP_LIMIT_NS,
+                               static_cast<uint64_t>(MAX_SAMPLE_GAP_PERIODS * 1e9 / updateFrequencyHz)))
+    , mLastSampleNs(0)
+    , mHasLastSample(false)
+{
+}
+
+float SampleClock::period(const Payload_IMU_t& payload)
+{
+    const uint64_t sampleNs = payload.acquisitionNs != 0 ? payload.acquisitionNs
+                                                         : static_cast<uint64_t>(payload.timestampGyro) * 1000000ULL;
+    const uint64_t lastNs = mLastSampleNs;
+    const bool hadLastSample = mHasLastSample;
+    mLastSampleNs = sampleNs;
+    mHasLastSample = true;
+
+    // Differences of the 32-bit millisecond timestamps stay correct across their wrap-around
+    uint64_t elapsedNs;
+    if (payload.acquisitionNs != 0)
+    {
+        if (!hadLastSample || sampleNs < lastNs)
+        {
+            return mNominalPeriod;
+        }
+        elapsedNs = sampleNs - lastNs;
+    }
+    else
+    {
+        if (!hadLastSample)
+        {
+            return mNominalPeriod;
+        }
+        const uint32_t elapsedMs = payload.timestampGyro - static_cast<uint32_t>(lastNs / 1000000ULL);
+        elapsedNs = static_cast<uint64_t>(elapsedMs) * 1000000ULL;
+    }
+
+    if (elapsedNs > mMaxSampleGapNs)
+    {
+        return mNominalPeriod;
+    }
+    return static_cast<float>(elapsedNs) * 1e-9f;
+}
@@ -0,0 +1,46 @@
+#pragma once
+
+#include <cstdint>
+
+typedef struct Payload_IMU_s Payload_IMU_t;
+
+/**
+ * @brief Integration period of consecutive samples of one stream, taken from their timestamps
+ *
+ * The period of a sample is the time elapsed since the previous one, so
+ * dropped, batched or decimated samples are integrated over the time they
+ * actually cover. The nanosecond acquisitionNs is used when set, and the
+ * millisecond timestampGyro otherwise. The nominal period is returned for
+ * the first sample, after a timestamp going backwards and after a gap longer
+ * than the gap limit, when integrating over the gap would be a guess.
+ */
+class SampleClock
+{
+public:
+    /** Longest interval between two samples still integrated as measured, in nominal periods */
+    static constexpr uint64_t MAX_SAMPLE_GAP_PERIODS = 10;
+
+    /** Lower bound of that interval, so that short bursts of losses at high rates are still measured */
+    static constexpr uint64_t MIN_SAMPLE_GAP_LIMIT_NS = 100000000ULL;
+
+    /**
+     * @brief Constructor with the nominal rate of the stream
+     *
+     * @param updateFrequencyHz The nominal update frequency in Hz
+     */
+    explicit SampleClock(const float updateFrequencyHz);
+
+    /**
+     * @brief Get the integration period of the next sample of the stream
+     *
+     * @param payload The IMU payload data
+     * @return Integration period in seconds
+     */
+    float period(const Payload_IMU_t& payload);
+
+private:
+    float mNominalPeriod;    ///< Nominal period in seconds, the fallback of period()
+    uint64_t mMaxSampleGapNs; ///< Longest interval integrated as measured, scaled from mNominalPeriod
+    uint64_t mLastSampleNs;  ///< Time of the previous sample in nanoseconds, valid if mHasLastSample
+    bool mHasLastSample;     ///< false until the first sample was seen
+};
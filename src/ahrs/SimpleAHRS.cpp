@@ -2,100 +2,142 @@
 #include "ahrs/SimpleAHRS.h"
 #include "core/PayloadIMU.h"
 
-SimpleAHRS::SimpleAHRS(const float updateFrequencyHz)
+template <typename Kp, typename Ki, SensorSet SENSORS, typename Scalar>
+SimpleAHRS<Kp, Ki, SENSORS, Scalar>::SimpleAHRS(const float updateFrequencyHz)
     : AHRS(updateFrequencyHz)
-    , mKp(4.50f)
-    , mKi(1.0f)
-    , mExInt(0.0f)
-    , mEyInt(0.0f)
-    , mEzInt(0.0f)
+    , mQ{1, 0, 0, 0}
+    , mExInt(0)
+    , mEyInt(0)
+    , mEzInt(0)
 {
 }
 
-void SimpleAHRS::update(const Payload_IMU_t& payload)
+template <typename Kp, typename Ki, SensorSet SENSORS, typename Scalar>
+void SimpleAHRS<Kp, Ki, SENSORS, Scalar>::update(const Payload_IMU_t& payload)
 {
-    float norm;
-    float hx, hy, hz, bx, bz;
-    float vx, vy, vz, wx, wy, wz;
-    float ex, ey, ez, halfT = mUpdatePeriod / 2.0f;
+    step(payload);
+    publish();
+}
+
+template <typename Kp, typename Ki, SensorSet SENSORS, typename Scalar>
+void SimpleAHRS<Kp, Ki, SENSORS, Scalar>::update(const Payload_IMU_t* samples, const size_t count)
+{
+    for (size_t i = 0; i < count; ++i)
+    {
+        step(samples[i]);
+    }
+    publish();
+}
+
+template <typename Kp, typename Ki, SensorSet SENSORS, typename Scalar>
+inline void SimpleAHRS<Kp, Ki, SENSORS, Scalar>::publish()
+{
+    for (int i = 0; i < 4; ++i)
+    {
+        mQuat[i] = static_cast<float>(mQ[i]);
+    }
+    mAnglesValid = false;
+}
+
+template <typename Kp, typename Ki, SensorSet SENSORS, typename Scalar>
+inline void SimpleAHRS<Kp, Ki, SENSORS, Scalar>::step(const Payload_IMU_t& payload)
+{
+    Scalar norm;
+    Scalar vx, vy, vz;
+    Scalar ex, ey, ez, halfT = samplePeriod(payload) / 2;
 
     // Convert gyro data from mdeg/s to rad/s
-    const float DEG_TO_RAD = 0.017453292f;
-    const float MDEG_TO_RAD = DEG_TO_RAD / 1000.0f;
-    float gx = payload.xGyro * MDEG_TO_RAD;
-    float gy = payload.yGyro * MDEG_TO_RAD;
-    float gz = payload.zGyro * MDEG_TO_RAD;
+    const Scalar DEG_TO_RAD = static_cast<Scalar>(0.017453292);
+    const Scalar MDEG_TO_RAD = DEG_TO_RAD / 1000;
+    Scalar gx = payload.xGyro * MDEG_TO_RAD;
+    Scalar gy = payload.yGyro * MDEG_TO_RAD;
+    Scalar gz = payload.zGyro * MDEG_TO_RAD;
     
-    // Local copies of acceleration and magnetometer data
-    float ax = payload.xAcc;
-    float ay = payload.yAcc;
-    float az = payload.zAcc;
-    float mx = payload.xMag;
-    float my = payload.yMag;
-    float mz = payload.zMag;
-
-    float q0q0 = mQuat[0] * mQuat[0];
-    float q0q1 = mQuat[0] * mQuat[1];
-    float q0q2 = mQuat[0] * mQuat[2];
-    float q0q3 = mQuat[0] * mQuat[3];
-    float q1q1 = mQuat[1] * mQuat[1];
-    float q1q2 = mQuat[1] * mQuat[2];
-    float q1q3 = mQuat[1] * mQuat[3];
-    float q2q2 = mQuat[2] * mQuat[2];
-    float q2q3 = mQuat[2] * mQuat[3];
-    float q3q3 = mQuat[3] * mQuat[3];
+    // Local copies of acceleration data
+    Scalar ax = payload.xAcc;
+    Scalar ay = payload.yAcc;
+    Scalar az = payload.zAcc;
+
+    Scalar q0q0 = mQ[0] * mQ[0];
+    Scalar q0q1 = mQ[0] * mQ[1];
+    Scalar q0q2 = mQ[0] * mQ[2];
+    Scalar q0q3 = mQ[0] * mQ[3];
+    Scalar q1q1 = mQ[1] * mQ[1];
+    Scalar q1q2 = mQ[1] * mQ[2];
+    Scalar q1q3 = mQ[1] * mQ[3];
+    Scalar q2q2 = mQ[2] * mQ[2];
+    Scalar q2q3 = mQ[2] * mQ[3];
+    Scalar q3q3 = mQ[3] * mQ[3];
 
     norm = invSqrt(ax * ax + ay * ay + az * az);
     ax = ax * norm;
     ay = ay * norm;
     az = az * norm;
 
-    norm = invSqrt(mx * mx + my * my + mz * mz);
-    mx = mx * norm;
-    my = my * norm;
-    mz = mz * norm;
-
-    // compute reference direction of flux
-    hx = 2 * mx * (0.5f - q2q2 - q3q3) + 2 * my * (q1q2 - q0q3) + 2 * mz * (q1q3 + q0q2);
-    hy = 2 * mx * (q1q2 + q0q3) + 2 * my * (0.5f - q1q1 - q3q3) + 2 * mz * (q2q3 - q0q1);
-    hz = 2 * mx * (q1q3 - q0q2) + 2 * my * (q2q3 + q0q1) + 2 * mz * (0.5f - q1q1 - q2q2);
-    bx = sqrt((hx * hx) + (hy * hy));
-    bz = hz;
-
-    // estimated direction of gravity and flux (v and w)
+    // estimated direction of gravity (v)
     vx = 2 * (q1q3 - q0q2);
     vy = 2 * (q0q1 + q2q3);
     vz = q0q0 - q1q1 - q2q2 + q3q3;
-    wx = 2 * bx * (0.5 - q2q2 - q3q3) + 2 * bz * (q1q3 - q0q2);
-    wy = 2 * bx * (q1q2 - q0q3) + 2 * bz * (q0q1 + q2q3);
-    wz = 2 * bx * (q0q2 + q1q3) + 2 * bz * (0.5 - q1q1 - q2q2);
 
     // error is sum of cross product between reference direction of fields and direction measured by sensors
-    ex = (ay * vz - az * vy) + (my * wz - mz * wy);
-    ey = (az * vx - ax * vz) + (mz * wx - mx * wz);
-    ez = (ax * vy - ay * vx) + (mx * wy - my * wx);
+    ex = ay * vz - az * vy;
+    ey = az * vx - ax * vz;
+    ez = ax * vy - ay * vx;
+
+    if constexpr (SENSORS == SensorSet::GYRO_ACCEL_MAG)
+    {
+        Scalar hx, hy, hz, bx, bz;
+        Scalar wx, wy, wz;
+        Scalar mx = payload.xMag;
+        Scalar my = payload.yMag;
+        Scalar mz = payload.zMag;
+
+        norm = invSqrt(mx * mx + my * my + mz * mz);
+        mx = mx * norm;
+        my = my * norm;
+        mz = mz * norm;
+
+        // compute reference direction of flux
+        hx = 2 * mx * (0.5f - q2q2 - q3q3) + 2 * my * (q1q2 - q0q3) + 2 * mz * (q1q3 + q0q2);
+        hy = 2 * mx * (q1q2 + q0q3) + 2 * my * (0.5f - q1q1 - q3q3) + 2 * mz * (q2q3 - q0q1);
+        hz = 2 * mx * (q1q3 - q0q2) + 2 * my * (q2q3 + q0q1) + 2 * mz * (0.5f - q1q1 - q2q2);
+        bx = std::sqrt((hx * hx) + (hy * hy));
+        bz = hz;
+
+        // estimated direction of flux (w)
+        wx = 2 * bx * (0.5 - q2q2 - q3q3) + 2 * bz * (q1q3 - q0q2);
+        wy = 2 * bx * (q1q2 - q0q3) + 2 * bz * (q0q1 + q2q3);
+        wz = 2 * bx * (q0q2 + q1q3) + 2 * bz * (0.5 - q1q1 - q2q2);
+
+        ex += my * wz - mz * wy;
+        ey += mz * wx - mx * wz;
+        ez += mx * wy - my * wx;
+    }
 
     if(ex != 0.0f && ey != 0.0f && ez != 0.0f)
     {
-        mExInt = mExInt + ex * mKi * halfT;
-        mEyInt = mEyInt + ey * mKi * halfT;
-        mEzInt = mEzInt + ez * mKi * halfT;
+        mExInt = mExInt + ex * KI * halfT;
+        mEyInt = mEyInt + ey * KI * halfT;
+        mEzInt = mEzInt + ez * KI * halfT;
 
-        gx = gx + mKp * ex + mExInt;
-        gy = gy + mKp * ey + mEyInt;
-        gz = gz + mKp * ez + mEzInt;
+        gx = gx + KP * ex + mExInt;
+        gy = gy + KP * ey + mEyInt;
+        gz = gz + KP * ez + mEzInt;
     }
 
-    mQuat[0] = mQuat[0] + (-mQuat[1] * gx - mQuat[2] * gy - mQuat[3] * gz) * halfT;
-    mQuat[1] = mQuat[1] + (mQuat[0] * gx + mQuat[2] * gz - mQuat[3] * gy) * halfT;
-    mQuat[2] = mQuat[2] + (mQuat[0] * gy - mQuat[1] * gz + mQuat[3] * gx) * halfT;
-    mQuat[3] = mQuat[3] + (mQuat[0] * gz + mQuat[1] * gy - mQuat[2] * gx) * halfT;
+    mQ[0] = mQ[0] + (-mQ[1] * gx - mQ[2] * gy - mQ[3] * gz) * halfT;
+    mQ[1] = mQ[1] + (mQ[0] * gx + mQ[2] * gz - mQ[3] * gy) * halfT;
+    mQ[2] = mQ[2] + (mQ[0] * gy - mQ[1] * gz + mQ[3] * gx) * halfT;
+    mQ[3] = mQ[3] + (mQ[0] * gz + mQ[1] * gy - mQ[2] * gx) * halfT;
 
-    norm = invSqrt(mQuat[0] * mQuat[0] + mQuat[1] * mQuat[1] + mQuat[2] * mQuat[2] + mQuat[3] * mQuat[3]);
-    mQuat[0] = mQuat[0] * norm;
-    mQuat[1] = mQuat[1] * norm;
-    mQuat[2] = mQuat[2] * norm;
-    mQuat[3] = mQuat[3] * norm;
+    norm = invSqrt(mQ[0] * mQ[0] + mQ[1] * mQ[1] + mQ[2] * mQ[2] + mQ[3] * mQ[3]);
+    mQ[0] = mQ[0] * norm;
+    mQ[1] = mQ[1] * norm;
+    mQ[2] = mQ[2] * norm;
+    mQ[3] = mQ[3] * norm;
+}
 
-    quatToAngles();
-} 
\ No newline at end of file
+template class SimpleAHRS<SimpleDefaultKp, SimpleDefaultKi, SensorSet::GYRO_ACCEL, float>;
+template class SimpleAHRS<SimpleDefaultKp, SimpleDefaultKi, SensorSet::GYRO_ACCEL_MAG, float>;
+template class SimpleAHRS<SimpleDefaultKp, SimpleDefaultKi, SensorSet::GYRO_ACCEL, double>;
+template class SimpleAHRS<SimpleDefaultKp, SimpleDefaultKi, SensorSet::GYRO_ACCEL_MAG, double>;
@@ -1,13 +1,39 @@
 #pragma once
 
+#include <ratio>
 #include "ahrs/AHRS.h"
+#include "core/SensorSet.h"
+
+/** Proportional gain of the shipped Simple filters */
+typedef std::ratio<9, 2> SimpleDefaultKp;
+/** Integral gain of the shipped Simple filters */
+typedef std::ratio<1> SimpleDefaultKi;
 
 /**
  * @brief Simple AHRS algorithm implementation
+ * 
+ * The gains, the sensors and the scalar type are template parameters, so each
+ * instantiation folds its constants. With SensorSet::GYRO_ACCEL the error only
+ * comes from gravity and the magnetometer is never read.
+ * 
+ * The member functions are defined in SimpleAHRS.cpp, which instantiates the
+ * shipped configurations.
+ * 
+ * @tparam Kp Proportional gain, as a std::ratio
+ * @tparam Ki Integral gain, as a std::ratio
+ * @tparam SENSORS Sensors fused by the filter
+ * @tparam Scalar Type of the state and of the arithmetic, float or double
  */
-class SimpleAHRS : public AHRS
+template <typename Kp = SimpleDefaultKp, typename Ki = SimpleDefaultKi, SensorSet SENSORS = SensorSet::GYRO_ACCEL_MAG,
+          typename Scalar = float>
+class SimpleAHRS final : public AHRS
 {
 public:
+    /** Proportional gain */
+    static constexpr Scalar KP = static_cast<Scalar>(Kp::num) / static_cast<Scalar>(Kp::den);
+    /** Integral gain */
+    static constexpr Scalar KI = static_cast<Scalar>(Ki::num) / static_cast<Scalar>(Ki::den);
+
     /**
      * @brief Constructor
      * 
@@ -21,10 +47,34 @@ public:
      * @param payload The IMU payload data
      */
     void update(const Payload_IMU_t& payload) override;
+
+    /**
+     * @brief Process consecutive IMU samples using Simple algorithm
+     * 
+     * @param samples The IMU samples, oldest first
+     * @param count Number of samples
+     */
+    void update(const Payload_IMU_t* samples, const size_t count) override;
     
 private:
-    // Algorithm parameters
-    float mKp; ///< Proportional gain
-    float mKi; ///< Integral gain
-    float mExInt, mEyInt, mEzInt; ///< Integral error terms
-}; 
\ No newline at end of file
+    /**
+     * @brief Advance the filter by one sample, leaving mQuat stale
+     * 
+     * @param payload The IMU payload data
+     */
+    void step(const Payload_IMU_t& payload);
+
+    /**
+     * @brief Copy the state to the float quaternion of the interface and mark the Euler angles stale
+     */
+    void publish();
+
+    Scalar mQ[4];                  ///< Quaternion [w, x, y, z] the filter works on
+    Scalar mExInt, mEyInt, mEzInt; ///< Integral error terms
+};
+
+// Configurations instantiated by SimpleAHRS.cpp
+extern template class SimpleAHRS<SimpleDefaultKp, SimpleDefaultKi, SensorSet::GYRO_ACCEL, float>;
+extern template class SimpleAHRS<SimpleDefaultKp, SimpleDefaultKi, SensorSet::GYRO_ACCEL_MAG, float>;
+extern template class SimpleAHRS<SimpleDefaultKp, SimpleDefaultKi, SensorSet::GYRO_ACCEL, double>;
+extern template class SimpleAHRS<SimpleDefaultKp, SimpleDefaultKi, SensorSet::GYRO_ACCEL_MAG, double>;
@@ -3,7 +3,9 @@
 #include <optional>
 #include <variant>
 #include <spdlog/spdlog.h>
+#include "core/AHRSPrecision.h"
 #include "core/AHRSType.h"
+#include "core/SensorSet.h"
 #include "ahrs/MadgwickAHRS.h"
 #include "ahrs/SimpleAHRS.h"
 
@@ -15,31 +17,55 @@ typedef struct Payload_IMU_s Payload_IMU_t;
  * This class demonstrates an alternative approach to polymorphism using C++17's std::variant.
  * Instead of using inheritance and virtual functions, it uses std::variant to store
  * different AHRS algorithm implementations and std::visit to dispatch operations.
+ * Every alternative is a compile-time specialised filter, the sensors and the
+ * precision picked at runtime only choose which one is held.
  */
 class VariantAHRS
 {
 public:
     /**
-     * @brief Variant type that can hold any of the AHRS algorithm implementations
+     * @brief Shipped Madgwick configurations, by sensor set and scalar type
      */
-    using AHRSVariant = std::variant<MadgwickAHRS, SimpleAHRS>;
+    template <SensorSet SENSORS, typename Scalar>
+    using Madgwick = MadgwickAHRS<MadgwickDefaultBeta, SENSORS, Scalar>;
+
+    /**
+     * @brief Shipped Simple configurations, by sensor set and scalar type
+     */
+    template <SensorSet SENSORS, typename Scalar>
+    using Simple = SimpleAHRS<SimpleDefaultKp, SimpleDefaultKi, SENSORS, Scalar>;
+
+    /**
+     * @brief Variant type that can hold any of the shipped AHRS instantiations
+     */
+    using AHRSVariant = std::variant<Madgwick<SensorSet::GYRO_ACCEL_MAG, float>,
+                                     Madgwick<SensorSet::GYRO_ACCEL, float>,
+                                     Madgwick<SensorSet::GYRO_ACCEL_MAG, double>,
+                                     Madgwick<SensorSet::GYRO_ACCEL, double>,
+                                     Simple<SensorSet::GYRO_ACCEL_MAG, float>,
+                                     Simple<SensorSet::GYRO_ACCEL, float>,
+                                     Simple<SensorSet::GYRO_ACCEL_MAG, double>,
+                                     Simple<SensorSet::GYRO_ACCEL, double>>;
     
     /**
      * @brief Create a VariantAHRS instance
      * 
      * @param type The AHRS algorithm type
      * @param updateFrequencyHz The update frequency in Hz
+     * @param ignoreMagnetometer Fuse the gyroscope and accelerometer only
+     * @param precision Scalar type the filter runs with
      * @return Optional VariantAHRS (empty if type is NONE)
      */
-    static std::optional<VariantAHRS> create(AHRSType type, float updateFrequencyHz)
+    static std::optional<VariantAHRS> create(AHRSType type, float updateFrequencyHz, bool ignoreMagnetometer = false,
+                                             AHRSPrecision precision = AHRSPrecision::FLOAT)
     {
         switch (type)
         {
             case AHRSType::MADGWICK:
-                return VariantAHRS(MadgwickAHRS(updateFrequencyHz));
+                return createFilter<Madgwick>(updateFrequencyHz, ignoreMagnetometer, precision);
                 
             case AHRSType::SIMPLE:
-                return VariantAHRS(SimpleAHRS(updateFrequencyHz));
+                return createFilter<Simple>(updateFrequencyHz, ignoreMagnetometer, precision);
                 
             case AHRSType::NONE:
             default:
@@ -54,7 +80,20 @@ public:
      */
     inline void update(const Payload_IMU_t& payload)
     {
-        std::visit([this, &payload](auto& ahrs) { this->processAHRSData(payload, ahrs); }, mVariant);
+        update(&payload, 1);
+    }
+
+    /**
+     * @brief Process consecutive IMU samples to update orientation
+     * 
+     * The algorithm is dispatched once for the whole span.
+     * 
+     * @param samples The IMU samples, oldest first
+     * @param count Number of samples
+     */
+    inline void update(const Payload_IMU_t* samples, const size_t count)
+    {
+        std::visit([this, samples, count](auto& ahrs) { this->processAHRSData(samples, count, ahrs); }, mVariant);
     }
     
     /**
@@ -86,27 +125,28 @@ private:
     template <typename T>
     explicit VariantAHRS(T&& ahrs) : mVariant(std::forward<T>(ahrs)) {}
 
-    template <typename T>
-    void processAHRSData(const Payload_IMU_t& data, T& ahrs)
+    /**
+     * @brief Create the instantiation of an algorithm matching the sensors and precision
+     */
+    template <template <SensorSet, typename> class Filter>
+    static VariantAHRS createFilter(const float updateFrequencyHz, const bool ignoreMagnetometer, const AHRSPrecision precision)
     {
-        // Use constexpr if to handle different AHRS types at compile time
-        if constexpr (std::is_same_v<T, MadgwickAHRS>)
-        {
-            // Madgwick-specific pre-processing
-            spdlog::debug("Processing with Madgwick algorithm");
-        } 
-        else if constexpr (std::is_same_v<T, SimpleAHRS>)
-        {
-            // Simple-specific pre-processing
-            spdlog::debug("Processing with Simple algorithm");
-        }
-        else
+        if (precision == AHRSPrecision::DOUBLE)
         {
-            // nothing to do in here
+            return ignoreMagnetometer ? VariantAHRS(Filter<SensorSet::GYRO_ACCEL, double>(updateFrequencyHz))
+                                      : VariantAHRS(Filter<SensorSet::GYRO_ACCEL_MAG, double>(updateFrequencyHz));
         }
-        
-        // Common processing
-        ahrs.update(data);
+        return ignoreMagnetometer ? VariantAHRS(Filter<SensorSet::GYRO_ACCEL, float>(updateFrequencyHz))
+                                  : VariantAHRS(Filter<SensorSet::GYRO_ACCEL_MAG, float>(updateFrequencyHz));
+    }
+
+    template <typename T>
+    void processAHRSData(const Payload_IMU_t* samples, const size_t count, T& ahrs)
+    {
+        spdlog::debug("Processing {} samples with AHRS instantiation {}", count, mVariant.index());
+
+        // The concrete type lets the per-sample steps be called directly
+        ahrs.update(samples, count);
     }
     
     AHRSVariant mVariant; ///< The variant holding the AHRS implementation
@@ -0,0 +1,612 @@
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <getopt.h>
+#include <iostream>
+#include <memory>
+#include <optional>
+#include <random>
+#include <spdlog/spdlog.h>
+#include <spdlog/sinks/stdout_color_sinks.h>
+#include <string>
+#include <unistd.h>
+#include <vector>
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
+
+#include "ahrs/AHRSEngine.h"
+#include "ahrs/MadgwickAHRSBank.h"
+#include "ahrs/VariantAHRS.h"
+#include "core/PayloadIMU.h"
+#include "providers/RandomIMUDataProvider.h"
+
+namespace
+{
+inline constexpr float UPDATE_FREQUENCY_HZ = 500.0f;
+inline constexpr uint64_t SAMPLE_PERIOD_NS = 2000000ULL;
+inline constexpr uint32_t MAG_DIVIDER = 5; ///< The recorded-like magnetometer runs at a fifth of the IMU rate
+inline constexpr size_t BATCH_SIZES[] = {1, 16, 256};
+inline constexpr size_t BANK_STREAMS = 64;
+inline constexpr size_t ENGINE_STREAMS = 64;
+#if defined(__OPTIMIZE__)
+inline constexpr bool OPTIMIZED = true;
+#else
+inline constexpr bool OPTIMIZED = false; ///< The ahrs library is built with the same flags
+#endif
+
+/**
+ * @brief Command line options of the benchmark
+ */
+struct Options
+{
+    size_t mSamples;     ///< Samples per measurement
+    int mRepeats;        ///< Measurements per case, the fastest is reported
+    size_t mWorkers;     ///< Worker threads of the engine cases, 0 for one per CPU
+    std::string mOutput; ///< JSON report path, empty for stdout
+};
+
+/**
+ * @brief Named input sequence
+ */
+struct Input
+{
+    std::string mName;                    ///< Name in the report
+    std::vector<Payload_IMU_t> mSamples;  ///< The samples, 500 Hz apart
+};
+
+/**
+ * @brief Filter configuration under test
+ */
+struct Config
+{
+    AHRSType mType;           ///< Algorithm
+    bool mIgnoreMagnetometer; ///< true for the 6-axis instantiation
+    AHRSPrecision mPrecision; ///< Scalar type
+};
+
+/**
+ * @brief One line of the report
+ */
+struct Result
+{
+    std::string mAlgorithm;  ///< madgwick or simple
+    std::string mSensors;    ///< gyro_accel_mag or gyro_accel
+    std::string mPrecision;  ///< float or double
+    std::string mDispatch;   ///< How the update is reached
+    std::string mInput;      ///< Input name
+    size_t mBatch;           ///< Samples per update call
+    bool mAngles;            ///< Euler angles read after every update call
+    double mNsPerSample;     ///< Wall time per sample
+    double mCyclesPerSample; ///< Time stamp counter cycles per sample, negative if unavailable
+};
+
+/**
+ * @brief Wall and cycle time of one measurement
+ */
+struct Timing
+{
+    double mNs;     ///< Elapsed nanoseconds
+    double mCycles; ///< Elapsed time stamp counter cycles, negative if unavailable
+};
+
+volatile float gSink; ///< Keeps the compiler from discarding the filter outputs
+
+inline double readCycles()
+{
+#if defined(__x86_64__) || defined(__i386__)
+    return static_cast<double>(__rdtsc());
+#else
+    return -1.0;
+#endif
+}
+
+/**
+ * @brief Run a measurement body several times and keep the fastest
+ *
+ * @param repeats Number of runs
+ * @param prepare Called before every run, not timed
+ * @param body The timed part
+ */
+template <typename Prepare, typename Body>
+Timing measure(const int repeats, Prepare&& prepare, Body&& body)
+{
+    Timing best{0.0, -1.0};
+    for (int run = 0; run < repeats; ++run)
+    {
+        prepare();
+        const auto start = std::chrono::steady_clock::now();
+        const double startCycles = readCycles();
+        body();
+        const double endCycles = readCycles();
+        const auto end = std::chrono::steady_clock::now();
+        const double ns = std::chrono::duration<double, std::nano>(end - start).count();
+        if (run == 0 || ns < best.mNs)
+        {
+            best.mNs = ns;
+            best.mCycles = startCycles < 0.0 ? -1.0 : endCycles - startCycles;
+        }
+    }
+    return best;
+}
+
+/**
+ * @brief Stamp samples as a 500 Hz stream with a new magnetometer reading every divider samples
+ */
+void stamp(std::vector<Payload_IMU_t>& samples, const uint32_t magDivider)
+{
+    for (size_t i = 0; i < samples.size(); ++i)
+    {
+        Payload_IMU_t& sample = samples[i];
+        sample.acquisitionNs = 1000000000ULL + i * SAMPLE_PERIOD_NS;
+        sample.timestampAcc = static_cast<uint32_t>(sample.acquisitionNs / 1000000ULL);
+        sample.timestampGyro = sample.timestampAcc;
+        sample.timestampMag = static_cast<uint32_t>(i / magDivider);
+        sample.publishNs = 0;
+    }
+}
+
+/**
+ * @brief Uniformly distributed samples of RandomIMUDataProvider
+ *
+ * The provider keeps its default seed so that every run sees the same
+ * values. Its wall clock timestamps are replaced by a regular 500 Hz clock,
+ * a generation loop would otherwise stamp many samples with the same time.
+ */
+Input makeRandomInput(const size_t count)
+{
+    Input input{"random", std::vector<Payload_IMU_t>(count)};
+    RandomIMUDataProvider provider;
+    for (Payload_IMU_t& sample : input.mSamples)
+    {
+        provider.getIMUData(sample);
+    }
+    stamp(input.mSamples, 1);
+    return input;
+}
+
+/**
+ * @brief Rotate a vector from the world frame into the body frame of a unit quaternion
+ */
+void toBody(const double q[4], const double world[3], double body[3])
+{
+    // body = q* (0, world) q
+    const double w = q[0], x = q[1], y = q[2], z = q[3];
+    body[0] = (1 - 2 * (y * y + z * z)) * world[0] + 2 * (x * y + w * z) * world[1] + 2 * (x * z - w * y) * world[2];
+    body[1] = 2 * (x * y - w * z) * world[0] + (1 - 2 * (x * x + z * z)) * world[1] + 2 * (y * z + w * x) * world[2];
+    body[2] = 2 * (x * z + w * y) * world[0] + 2 * (y * z - w * x) * world[1] + (1 - 2 * (x * x + y * y)) * world[2];
+}
+
+/**
+ * @brief Samples of a simulated unit under smooth rotation, as a real recording would contain
+ *
+ * The gyroscope measures the true rate, the accelerometer gravity and the
+ * magnetometer an inclined Earth field, both in the rotating body frame,
+ * with sensor noise. The magnetometer is sampled at 100 Hz.
+ */
+Input makeRecordedInput(const size_t count)
+{
+    Input input{"recorded", std::vector<Payload_IMU_t>(count)};
+    std::mt19937 generator(42);
+    std::normal_distribution<double> gyroNoise(0.0, 300.0); // mdeg/s
+    std::normal_distribution<double> accNoise(0.0, 15.0);   // mg
+    std::normal_distribution<double> magNoise(0.0, 3.0);    // mGauss
+    const double gravity[3] = {0.0, 0.0, 1000.0};
+    const double field[3] = {200.0, 0.0, -400.0};
+    const double period = static_cast<double>(SAMPLE_PERIOD_NS) * 1e-9;
+    const double RAD_TO_MDEG = 180000.0 / M_PI;
+
+    double q[4] = {1.0, 0.0, 0.0, 0.0};
+    double mag[3] = {0.0, 0.0, 0.0};
+    for (size_t i = 0; i < count; ++i)
+    {
+        const double t = static_cast<double>(i) * period;
+        const double rate[3] = {0.8 * std::sin(2 * M_PI * 0.3 * t), 0.5 * std::sin(2 * M_PI * 0.17 * t + 1.0),
+                                0.3 * std::sin(2 * M_PI * 0.05 * t)};
+        const double qDot[4] = {0.5 * (-q[1] * rate[0] - q[2] * rate[1] - q[3] * rate[2]),
+                                0.5 * (q[0] * rate[0] + q[2] * rate[2] - q[3] * rate[1]),
+                                0.5 * (q[0] * rate[1] - q[1] * rate[2] + q[3] * rate[0]),
+                                0.5 * (q[0] * rate[2] + q[1] * rate[1] - q[2] * rate[0])};
+        double norm = 0.0;
+        for (int c = 0; c < 4; ++c)
+        {
+            q[c] += qDot[c] * period;
+            norm += q[c] * q[c];
+        }
+        for (int c = 0; c < 4; ++c)
+        {
+            q[c] /= std::sqrt(norm);
+        }
+
+        double acc[3];
+        toBody(q, gravity, acc);
+        if (i % MAG_DIVIDER == 0)
+        {
+            toBody(q, field, mag);
+            for (int c = 0; c < 3; ++c)
+            {
+                mag[c] += magNoise(generator);
+            }
+        }
+
+        Payload_IMU_t& sample = input.mSamples[i];
+        memset(&sample, 0, sizeof(sample));
+        sample.xGyro = static_cast<float>(rate[0] * RAD_TO_MDEG + gyroNoise(generator));
+        sample.yGyro = static_cast<float>(rate[1] * RAD_TO_MDEG + gyroNoise(generator));
+        sample.zGyro = static_cast<float>(rate[2] * RAD_TO_MDEG + gyroNoise(generator));
+        sample.xAcc = static_cast<float>(acc[0] + accNoise(generator));
+        sample.yAcc = static_cast<float>(acc[1] + accNoise(generator));
+        sample.zAcc = static_cast<float>(acc[2] + accNoise(generator));
+        sample.xMag = static_cast<float>(mag[0]);
+        sample.yMag = static_cast<float>(mag[1]);
+        sample.zMag = static_cast<float>(mag[2]);
+    }
+    stamp(input.mSamples, MAG_DIVIDER);
+    return input;
+}
+
+const char* algorithmName(const AHRSType type)
+{
+    return type == AHRSType::MADGWICK ? "madgwick" : "simple";
+}
+
+const char* sensorsName(const bool ignoreMagnetometer)
+{
+    return ignoreMagnetometer ? "gyro_accel" : "gyro_accel_mag";
+}
+
+const char* precisionName(const AHRSPrecision precision)
+{
+    return precision == AHRSPrecision::DOUBLE ? "double" : "float";
+}
+
+/**
+ * @brief Feed an input to an update function in batches, reading the angles after each call if asked to
+ */
+template <typename Update, typename Angles>
+inline void feed(const Input& input, const size_t batch, const bool angles, Update&& update, Angles&& getAngles)
+{
+    const Payload_IMU_t* samples = input.mSamples.data();
+    const size_t count = input.mSamples.size();
+    for (size_t i = 0; i < count; i += batch)
+    {
+        update(samples + i, std::min(batch, count - i));
+        if (angles)
+        {
+            gSink = getAngles()[0];
+        }
+    }
+}
+
+void addResult(std::vector<Result>& results, const Config& config, const std::string& dispatch, const Input& input,
+               const size_t batch, const bool angles, const Timing& timing)
+{
+    const double samples = static_cast<double>(input.mSamples.size());
+    Result result{algorithmName(config.mType), sensorsName(config.mIgnoreMagnetometer), precisionName(config.mPrecision),
+                  dispatch, input.mName, batch, angles, timing.mNs / samples,
+                  timing.mCycles < 0.0 ? -1.0 : timing.mCycles / samples};
+    spdlog::info("{:8} {:14} {:6} {:13} {:8} batch {:3} angles {:d}: {:8.1f} ns/sample {:8.1f} cycles/sample",
+                 result.mAlgorithm, result.mSensors, result.mPrecision, result.mDispatch, result.mInput, result.mBatch,
+                 result.mAngles, result.mNsPerSample, result.mCyclesPerSample);
+    results.push_back(result);
+}
+
+/**
+ * @brief Measure one filter instantiation through direct, virtual and variant dispatch
+ *
+ * @tparam Filter The concrete filter class, final
+ */
+template <typename Filter>
+void benchFilter(const Options& options, const Config& config, const std::vector<Input>& inputs,
+                 std::vector<Result>& results)
+{
+    for (const Input& input : inputs)
+    {
+        for (const size_t batch : BATCH_SIZES)
+        {
+            for (const bool angles : {false, true})
+            {
+                // Calls on the final class are resolved at compile time
+                std::optional<Filter> filter;
+                Timing timing = measure(options.mRepeats, [&]() { filter.emplace(UPDATE_FREQUENCY_HZ); }, [&]() {
+                    feed(input, batch, angles,
+                         [&](const Payload_IMU_t* samples, const size_t count) {
+                             if (count == 1)
+                             {
+                                 filter->update(*samples);
+                             }
+                             else
+                             {
+                                 filter->update(samples, count);
+                             }
+                         },
+                         [&]() { return filter->getAngles(); });
+                });
+                addResult(results, config, "direct", input, batch, angles, timing);
+
+                // The empty asm hides the dynamic type, so every call goes through the vtable
+                AHRS* base = nullptr;
+                timing = measure(options.mRepeats,
+                                 [&]() {
+                                     filter.emplace(UPDATE_FREQUENCY_HZ);
+                                     base = &*filter;
+                                     asm volatile("" : "+r"(base));
+                                 },
+                                 [&]() {
+                                     feed(input, batch, angles,
+                                          [&](const Payload_IMU_t* samples, const size_t count) {
+                                              if (count == 1)
+                                              {
+                                                  base->update(*samples);
+                                              }
+                                              else
+                                              {
+                                                  base->update(samples, count);
+                                              }
+                                          },
+                                          [&]() { return base->getAngles(); });
+                                 });
+                addResult(results, config, "virtual", input, batch, angles, timing);
+
+                std::optional<VariantAHRS> variant;
+                timing = measure(options.mRepeats,
+                                 [&]() {
+                                     variant = VariantAHRS::create(config.mType, UPDATE_FREQUENCY_HZ,
+                                                                   config.mIgnoreMagnetometer, config.mPrecision);
+                                 },
+                                 [&]() {
+                                     feed(input, batch, angles,
+                                          [&](const Payload_IMU_t* samples, const size_t count) {
+                                              if (count == 1)
+                                              {
+                                                  variant->update(*samples);
+                                              }
+                                              else
+                                              {
+                                                  variant->update(samples, count);
+                                              }
+                                          },
+                                          [&]() { return variant->getAngles(); });
+                                 });
+                addResult(results, config, "variant", input, batch, angles, timing);
+            }
+        }
+    }
+}
+
+/**
+ * @brief Measure the engine, with the input split across ENGINE_STREAMS streams submitted in batches
+ */
+void benchEngine(const Options& options, const Config& config, const std::vector<Input>& inputs,
+                 std::vector<Result>& results)
+{
+    for (const Input& input : inputs)
+    {
+        const size_t perStream = input.mSamples.size() / ENGINE_STREAMS;
+        for (const size_t batch : BATCH_SIZES)
+        {
+            std::unique_ptr<AHRSEngine> engine;
+            const Timing timing = measure(
+                options.mRepeats,
+                [&]() {
+                    engine.reset();
+                    engine.reset(new AHRSEngine(options.mWorkers, config.mType, UPDATE_FREQUENCY_HZ,
+                                                config.mIgnoreMagnetometer, config.mPrecision));
+                    for (uint32_t stream = 0; stream < ENGINE_STREAMS; ++stream)
+                    {
+                        engine->addStream(stream);
+                    }
+                    engine->start();
+                },
+                [&]() {
+                    for (size_t i = 0; i < perStream; i += batch)
+                    {
+                        for (uint32_t stream = 0; stream < ENGINE_STREAMS; ++stream)
+                        {
+                            engine->submit(stream, &input.mSamples[stream * perStream + i], std::min(batch, perStream - i));
+                        }
+                    }
+                    engine->waitIdle();
+                });
+            addResult(results, config, "engine", input, batch, false, timing);
+        }
+    }
+}
+
+/**
+ * @brief Measure every bank kernel supported by the CPU, one update advances BANK_STREAMS streams
+ */
+void benchBank(const Options& options, const std::vector<Input>& inputs, std::vector<Result>& results)
+{
+    const Config config{AHRSType::MADGWICK, false, AHRSPrecision::FLOAT};
+    for (MadgwickAHRSBank::Kernel kernel : {MadgwickAHRSBank::Kernel::SCALAR, MadgwickAHRSBank::Kernel::SSE,
+                                            MadgwickAHRSBank::Kernel::AVX2, MadgwickAHRSBank::Kernel::AVX512})
+    {
+        if (!MadgwickAHRSBank::isSupported(kernel))
+        {
+            continue;
+        }
+        for (const Input& input : inputs)
+        {
+            const size_t steps = input.mSamples.size() / BANK_STREAMS;
+            std::optional<MadgwickAHRSBank> bank;
+            const Timing timing = measure(
+                options.mRepeats, [&]() { bank.emplace(BANK_STREAMS, UPDATE_FREQUENCY_HZ, kernel); },
+                [&]() {
+                    for (size_t step = 0; step < steps; ++step)
+                    {
+                        bank->update(&input.mSamples[step * BANK_STREAMS]);
+                    }
+                    float quat[4];
+                    bank->getQuaternion(0, quat);
+                    gSink = quat[0];
+                });
+            addResult(results, config, std::string("bank_") + MadgwickAHRSBank::getKernelName(kernel), input,
+                      BANK_STREAMS, false, timing);
+        }
+    }
+}
+
+const char* invSqrtName()
+{
+#if defined(AHRS_INV_SQRT_RSQRT)
+    return "RSQRT";
+#elif defined(AHRS_INV_SQRT_RSQRT_NR1)
+    return "RSQRT_NR1";
+#elif defined(AHRS_INV_SQRT_RSQRT_NR2)
+    return "RSQRT_NR2";
+#else
+    return "EXACT";
+#endif
+}
+
+void writeJson(FILE* file, const Options& options, const std::vector<Result>& results)
+{
+    fprintf(file, "{\n");
+    fprintf(file, "  \"benchmark\": \"ahrs_bench\",\n");
+    fprintf(file, "  \"samples\": %zu,\n", options.mSamples);
+    fprintf(file, "  \"repeats\": %d,\n", options.mRepeats);
+    fprintf(file, "  \"online_cpus\": %ld,\n", sysconf(_SC_NPROCESSORS_ONLN));
+    fprintf(file, "  \"inv_sqrt\": \"%s\",\n", invSqrtName());
+    fprintf(file, "  \"optimized\": %s,\n", OPTIMIZED ? "true" : "false");
+    fprintf(file, "  \"cycle_counter\": %s,\n", readCycles() < 0.0 ? "null" : "\"tsc\"");
+    fprintf(file, "  \"results\": [\n");
+    for (size_t i = 0; i < results.size(); ++i)
+    {
+        const Result& result = results[i];
+        fprintf(file,
+                "    {\"algorithm\": \"%s\", \"sensors\": \"%s\", \"precision\": \"%s\", \"dispatch\": \"%s\", "
+                "\"input\": \"%s\", \"batch\": %zu, \"angles\": %s, \"ns_per_sample\": %.3f, "
+                "\"samples_per_sec\": %.0f, \"cycles_per_sample\": ",
+                result.mAlgorithm.c_str(), result.mSensors.c_str(), result.mPrecision.c_str(),
+                result.mDispatch.c_str(), result.mInput.c_str(), result.mBatch, result.mAngles ? "true" : "false",
+                result.mNsPerSample, 1e9 / result.mNsPerSample);
+        if (result.mCyclesPerSample < 0.0)
+        {
+            fprintf(file, "null}");
+        }
+        else
+        {
+            fprintf(file, "%.2f}", result.mCyclesPerSample);
+        }
+        fprintf(file, "%s\n", i + 1 < results.size() ? "," : "");
+    }
+    fprintf(file, "  ]\n}\n");
+}
+
+void printUsage(const char* programName)
+{
+    std::cerr << "Usage: " << programName << " [options]\n"
+              << "Options:\n"
+              << "  --samples      : Samples per measurement (default 100000)\n"
+              << "  --repeats      : Measurements per case, the fastest is reported (default 3)\n"
+              << "  --workers      : Worker threads of the engine cases (default one per CPU)\n"
+              << "  --output       : JSON report path (default stdout)\n";
+}
+
+bool parseOptions(int argc, char* argv[], Options& options)
+{
+    constexpr struct option long_options[] = {
+        {"samples", required_argument, 0, 'n'},
+        {"repeats", required_argument, 0, 'r'},
+        {"workers", required_argument, 0, 'w'},
+        {"output", required_argument, 0, 'o'},
+        {0, 0, 0, 0}
+    };
+
+    int opt;
+    while ((opt = getopt_long(argc, argv, "n:r:w:o:", long_options, nullptr)) != -1)
+    {
+        switch (opt)
+        {
+            case 'n':
+                options.mSamples = std::stoul(optarg);
+                if (options.mSamples < ENGINE_STREAMS * BATCH_SIZES[2])
+                {
+                    spdlog::error("Invalid sample count (must be at least {}): {}", ENGINE_STREAMS * BATCH_SIZES[2],
+                                  options.mSamples);
+                    return false;
+                }
+                break;
+            case 'r':
+                options.mRepeats = std::stoi(optarg);
+                if (options.mRepeats < 1)
+                {
+                    spdlog::error("Invalid repeat count (must be positive): {}", options.mRepeats);
+                    return false;
+                }
+                break;
+            case 'w':
+                options.mWorkers = std::stoul(optarg);
+                break;
+            case 'o':
+                options.mOutput = optarg;
+                break;
+            default:
+                return false;
+        }
+    }
+    return true;
+}
+} // end of anonymous namespace
+
+int main(int argc, char* argv[])
+{
+    // The report goes to stdout, progress to stderr
+    spdlog::set_default_logger(spdlog::stderr_color_mt("ahrs_bench"));
+    spdlog::set_level(spdlog::level::info);
+
+    Options options{100000, 3, 0, ""};
+    if (!parseOptions(argc, argv, options))
+    {
+        printUsage(argv[0]);
+        return 1;
+    }
+
+    if (!OPTIMIZED)
+    {
+        spdlog::warn("Built without optimisation, configure with -DCMAKE_BUILD_TYPE=Release for meaningful numbers");
+    }
+
+    const std::vector<Input> inputs = {makeRecordedInput(options.mSamples), makeRandomInput(options.mSamples)};
+    std::vector<Result> results;
+
+    const Config MADGWICK_MARG_FLOAT{AHRSType::MADGWICK, false, AHRSPrecision::FLOAT};
+    const Config MADGWICK_IMU_FLOAT{AHRSType::MADGWICK, true, AHRSPrecision::FLOAT};
+    const Config MADGWICK_MARG_DOUBLE{AHRSType::MADGWICK, false, AHRSPrecision::DOUBLE};
+    const Config MADGWICK_IMU_DOUBLE{AHRSType::MADGWICK, true, AHRSPrecision::DOUBLE};
+    const Config SIMPLE_MARG_FLOAT{AHRSType::SIMPLE, false, AHRSPrecision::FLOAT};
+    const Config SIMPLE_IMU_FLOAT{AHRSType::SIMPLE, true, AHRSPrecision::FLOAT};
+    const Config SIMPLE_MARG_DOUBLE{AHRSType::SIMPLE, false, AHRSPrecision::DOUBLE};
+    const Config SIMPLE_IMU_DOUBLE{AHRSType::SIMPLE, true, AHRSPrecision::DOUBLE};
+
+    benchFilter<VariantAHRS::Madgwick<SensorSet::GYRO_ACCEL_MAG, float>>(options, MADGWICK_MARG_FLOAT, inputs, results);
+    benchFilter<VariantAHRS::Madgwick<SensorSet::GYRO_ACCEL, float>>(options, MADGWICK_IMU_FLOAT, inputs, results);
+    benchFilter<VariantAHRS::Madgwick<SensorSet::GYRO_ACCEL_MAG, double>>(options, MADGWICK_MARG_DOUBLE, inputs, results);
+    benchFilter<VariantAHRS::Madgwick<SensorSet::GYRO_ACCEL, double>>(options, MADGWICK_IMU_DOUBLE, inputs, results);
+    benchFilter<VariantAHRS::Simple<SensorSet::GYRO_ACCEL_MAG, float>>(options, SIMPLE_MARG_FLOAT, inputs, results);
+    benchFilter<VariantAHRS::Simple<SensorSet::GYRO_ACCEL, float>>(options, SIMPLE_IMU_FLOAT, inputs, results);
+    benchFilter<VariantAHRS::Simple<SensorSet::GYRO_ACCEL_MAG, double>>(options, SIMPLE_MARG_DOUBLE, inputs, results);
+    benchFilter<VariantAHRS::Simple<SensorSet::GYRO_ACCEL, double>>(options, SIMPLE_IMU_DOUBLE, inputs, results);
+    benchBank(options, inputs, results);
+    for (const Config& config : {MADGWICK_MARG_FLOAT, SIMPLE_MARG_FLOAT})
+    {
+        benchEngine(options, config, inputs, results);
+    }
+
+    FILE* file = options.mOutput.empty() ? stdout : fopen(options.mOutput.c_str(), "w");
+    if (file == nullptr)
+    {
+        spdlog::error("Failed to open {}: {}", options.mOutput, strerror(errno));
+        return 1;
+    }
+    writeJson(file, options, results);
+    if (file != stdout)
+    {
+        fclose(file);
+        spdlog::info("Report written to {}", options.mOutput);
+    }
+    return 0;
+}
@@ -0,0 +1,559 @@
+#include <cerrno>
+#include <csignal>
+#include <cstdio>
+#include <cstring>
+#include <fcntl.h>
+#include <filesystem>
+#include <getopt.h>
+#include <iostream>
+#include <memory>
+#include <sstream>
+#include <spdlog/spdlog.h>
+#include <spdlog/sinks/stdout_color_sinks.h>
+#include <string>
+#include <sys/mman.h>
+#include <sys/resource.h>
+#include <sys/wait.h>
+#include <time.h>
+#include <unistd.h>
+#include <vector>
+
+#include "communication/IMUPublisher.h"
+#include "communication/IMUSubscriber.h"
+#include "core/Parameters.h"
+#include "providers/FileIMUDataProvider.h"
+#include "providers/RandomIMUDataProvider.h"
+#include "utils/LatencyHistogram.h"
+#include "utils/utils.h"
+
+namespace
+{
+inline constexpr ulong DEFAULT_TIMEOUT_MS = 2000; ///< Subscribers of an overloaded point may wait long for the CPU
+inline constexpr long NSEC_PER_SEC = 1000000000L;
+
+/**
+ * @brief Command line options of the benchmark, the transport options are Parameters
+ */
+struct Options
+{
+    std::vector<int> mRates;       ///< Publishing rates to sweep in Hz
+    std::vector<int> mSubscribers; ///< Subscriber counts to sweep
+    long mDurationMs;              ///< Time every subscriber receives for, per point
+    std::string mOutput;           ///< Report path, empty for stdout
+    bool mCsv;                     ///< Write CSV instead of JSON
+    std::string mLabel;            ///< Free text copied to every row, to tell builds apart
+};
+
+/**
+ * @brief What a subscriber process reports, lives in memory shared with the parent
+ */
+struct SubscriberSlot
+{
+    bool mDone;                        ///< The subscriber ran and filled the slot
+    bool mTimedOut;                    ///< The publisher went silent for longer than --timeout-ms
+    uint64_t mReceived;                ///< Unique samples received
+    uint64_t mLost;                    ///< Samples missing from the received sequence
+    long mElapsedNs;                   ///< Time the receive thread ran for
+    long mCpuNs;                       ///< CPU time of the subscriber process while receiving
+    LatencyHistogram mTransportLatency; ///< Publish to receive latency
+    LatencyHistogram mEndToEndLatency;  ///< Acquisition to processed latency
+};
+
+/**
+ * @brief Measurements of one point of the sweep
+ */
+struct Point
+{
+    int mRateHz;                ///< Publishing rate
+    int mSubscribers;           ///< Subscribers started
+    int mFailed;                ///< Subscribers that could not start or timed out
+    uint64_t mPublished;        ///< Samples published
+    uint64_t mReceived;         ///< Samples received by all subscribers
+    uint64_t mLost;             ///< Samples lost by all subscribers
+    double mDeliveredHz;        ///< Mean receive rate of a subscriber
+    double mCpuNsPerSample;     ///< CPU time of publisher and subscribers per received sample
+    double mPublisherCpuNs;     ///< CPU time of the publisher per published sample
+    LatencyHistogram mCycleTime; ///< Publisher cycle time
+    LatencyHistogram mLateness;  ///< Publisher wakeup lateness
+    LatencyHistogram mTransportLatency; ///< Publish to receive latency of all subscribers
+    LatencyHistogram mEndToEndLatency;  ///< Acquisition to processed latency of all subscribers
+};
+
+volatile sig_atomic_t gTimedOut = 0; ///< Set in a subscriber process by the timeout SIGALRM
+
+void timeoutHandler(int)
+{
+    gTimedOut = 1;
+}
+
+inline long toNs(const struct timespec& time)
+{
+    return time.tv_sec * NSEC_PER_SEC + time.tv_nsec;
+}
+
+inline long monotonicNs()
+{
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return toNs(now);
+}
+
+inline long cpuNs(const int who)
+{
+    struct rusage usage;
+    getrusage(who, &usage);
+    return (usage.ru_utime.tv_sec + usage.ru_stime.tv_sec) * NSEC_PER_SEC +
+           (usage.ru_utime.tv_usec + usage.ru_stime.tv_usec) * 1000L;
+}
+
+const char* transportName(const TransportType transport)
+{
+    switch (transport)
+    {
+        case TransportType::SHM:
+            return "shm";
+        case TransportType::MEMFD:
+            return "memfd";
+        case TransportType::UDP:
+            return "udp";
+        default:
+            return "socket";
+    }
+}
+
+/**
+ * @brief Body of a subscriber process: wait for the start signal, receive for the duration, report
+ */
+void runSubscriber(const Parameters& params, const long durationMs, const int startPipe, SubscriberSlot& slot)
+{
+    // Closing the write end in the parent releases all subscribers at once
+    char byte;
+    while (read(startPipe, &byte, 1) < 0 && errno == EINTR)
+    {
+    }
+    close(startPipe);
+    signal(SIGALRM, timeoutHandler);
+
+    // The subscriber prints every wakeup to stdout, which carries the report
+    const int devNull = open("/dev/null", O_WRONLY);
+    if (devNull >= 0)
+    {
+        dup2(devNull, STDOUT_FILENO);
+        close(devNull);
+    }
+
+    IMUSubscriber subscriber;
+    if (!subscriber.initialise(params))
+    {
+        return;
+    }
+    const long startNs = monotonicNs();
+    const long startCpuNs = cpuNs(RUSAGE_SELF);
+    subscriber.startThread();
+    const long endNs = startNs + durationMs * 1000000L;
+    for (long nowNs = startNs; nowNs < endNs && !gTimedOut; nowNs = monotonicNs())
+    {
+        const struct timespec pause = {0, std::min(endNs - nowNs, 10000000L)};
+        nanosleep(&pause, nullptr);
+    }
+    subscriber.stopThread();
+
+    slot.mTimedOut = gTimedOut != 0;
+    slot.mReceived = subscriber.getSequenceTracker().getReceived();
+    slot.mLost = subscriber.getSequenceTracker().getLost();
+    slot.mElapsedNs = monotonicNs() - startNs;
+    slot.mCpuNs = cpuNs(RUSAGE_SELF) - startCpuNs;
+    slot.mTransportLatency = subscriber.getTransportLatency();
+    slot.mEndToEndLatency = subscriber.getEndToEndLatency();
+    slot.mDone = true;
+}
+
+/**
+ * @brief Run one publisher in this process and subscribers in child processes
+ *
+ * The children are forked before the publisher thread exists, so that they
+ * inherit no lock held by another thread. They wait on a pipe until the
+ * publisher is ready and then run for the duration on their own.
+ *
+ * @return true if the point was measured
+ */
+bool runPoint(const Options& options, Parameters params, const int rateHz, const int subscribers, Point& point)
+{
+    const std::filesystem::path directory = params.mSocketPath;
+    params.mSocketPath = (directory / "imu").string();
+    params.mFrequencyHz = rateHz;
+    point = Point();
+    point.mRateHz = rateHz;
+    point.mSubscribers = subscribers;
+
+    const size_t slotsBytes = sizeof(SubscriberSlot) * subscribers;
+    void* shared = mmap(nullptr, slotsBytes, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+    if (shared == MAP_FAILED)
+    {
+        spdlog::error("Failed to map the subscriber results: {}", strerror(errno));
+        return false;
+    }
+    SubscriberSlot* slots = static_cast<SubscriberSlot*>(shared);
+    for (int i = 0; i < subscribers; ++i)
+    {
+        new (&slots[i]) SubscriberSlot();
+    }
+
+    int startPipe[2];
+    if (pipe(startPipe) < 0)
+    {
+        spdlog::error("Failed to create the start pipe: {}", strerror(errno));
+        munmap(shared, slotsBytes);
+        return false;
+    }
+
+    std::vector<pid_t> children;
+    for (int i = 0; i < subscribers; ++i)
+    {
+        const pid_t pid = fork();
+        if (pid == 0)
+        {
+            close(startPipe[1]);
+            runSubscriber(params, options.mDurationMs, startPipe[0], slots[i]);
+            _exit(0);
+        }
+        if (pid < 0)
+        {
+            spdlog::error("Failed to start subscriber {}: {}", i, strerror(errno));
+            break;
+        }
+        children.push_back(pid);
+    }
+    close(startPipe[0]);
+
+    std::unique_ptr<IMUDataProvider> provider;
+    if (params.mReplayFile.empty())
+    {
+        provider = std::make_unique<RandomIMUDataProvider>();
+    }
+    else
+    {
+        provider = std::make_unique<FileIMUDataProvider>(params.mReplayFile, params.mReplaySpeed,
+                                                         params.mReplayLoop, params.mFrequencyHz);
+    }
+    IMUPublisher publisher(*provider);
+    const bool ready = publisher.initialise(params);
+    const long publisherCpuBeforeNs = cpuNs(RUSAGE_SELF);
+    if (ready)
+    {
+        publisher.startThread();
+    }
+    else
+    {
+        spdlog::error("Failed to initialise the publisher");
+    }
+    close(startPipe[1]);
+
+    for (const pid_t pid : children)
+    {
+        int status;
+        while (waitpid(pid, &status, 0) < 0 && errno == EINTR)
+        {
+        }
+    }
+    if (ready)
+    {
+        publisher.stopThread();
+    }
+    const long publisherCpuNs = cpuNs(RUSAGE_SELF) - publisherCpuBeforeNs;
+
+    point.mPublished = publisher.getCycleTime().getCount();
+    point.mCycleTime = publisher.getCycleTime();
+    point.mLateness = publisher.getLateness();
+    long subscribersCpuNs = 0;
+    double rateSum = 0.0;
+    int measured = 0;
+    for (int i = 0; i < subscribers; ++i)
+    {
+        const SubscriberSlot& slot = slots[i];
+        if (!slot.mDone || slot.mTimedOut)
+        {
+            ++point.mFailed;
+        }
+        if (!slot.mDone)
+        {
+            continue;
+        }
+        point.mReceived += slot.mReceived;
+        point.mLost += slot.mLost;
+        point.mTransportLatency.merge(slot.mTransportLatency);
+        point.mEndToEndLatency.merge(slot.mEndToEndLatency);
+        subscribersCpuNs += slot.mCpuNs;
+        rateSum += slot.mElapsedNs > 0 ? slot.mReceived * 1e9 / slot.mElapsedNs : 0.0;
+        ++measured;
+    }
+    point.mDeliveredHz = measured > 0 ? rateSum / measured : 0.0;
+    point.mCpuNsPerSample =
+        point.mReceived > 0 ? static_cast<double>(publisherCpuNs + subscribersCpuNs) / point.mReceived : 0.0;
+    point.mPublisherCpuNs = point.mPublished > 0 ? static_cast<double>(publisherCpuNs) / point.mPublished : 0.0;
+
+    munmap(shared, slotsBytes);
+    return ready && !children.empty();
+}
+
+double lossPercent(const Point& point)
+{
+    const uint64_t expected = point.mReceived + point.mLost;
+    return expected > 0 ? 100.0 * point.mLost / expected : 0.0;
+}
+
+/** Columns of the report, in the order of writeRow() */
+const char* const COLUMNS[] = {
+    "label", "transport", "batch_size", "recv_batch", "io_backend", "rate_hz", "subscribers", "failed_subscribers",
+    "published", "received", "lost", "loss_pct", "delivered_hz", "cpu_ns_per_sample", "publisher_cpu_ns_per_sample",
+    "cycle_p50_us", "cycle_p99_us", "cycle_max_us", "lateness_p99_us", "latency_p50_us", "latency_p99_us",
+    "latency_p999_us", "latency_max_us", "end_to_end_p50_us", "end_to_end_p99_us", "end_to_end_max_us"
+};
+
+/**
+ * @brief Write one point, as a CSV line or a JSON object
+ */
+void writeRow(FILE* file, const bool csv, const Options& options, const Parameters& params, const Point& point)
+{
+    const auto us = [](const uint64_t ns) { return ns / 1e3; };
+    const std::string label = options.mLabel;
+    const char* backend = params.mIoBackend == IoBackend::URING ? "uring" : "socket";
+    if (csv)
+    {
+        fprintf(file, "%s,%s,%d,%d,%s,", label.c_str(), transportName(params.mTransport), params.mBatchSize,
+                params.mRecvBatch, backend);
+    }
+    else
+    {
+        fprintf(file, "    {\"%s\": \"%s\", \"%s\": \"%s\", \"%s\": %d, \"%s\": %d, \"%s\": \"%s\", ", COLUMNS[0],
+                label.c_str(), COLUMNS[1], transportName(params.mTransport), COLUMNS[2], params.mBatchSize, COLUMNS[3],
+                params.mRecvBatch, COLUMNS[4], backend);
+    }
+
+    const double values[] = {
+        static_cast<double>(point.mRateHz), static_cast<double>(point.mSubscribers), static_cast<double>(point.mFailed),
+        static_cast<double>(point.mPublished), static_cast<double>(point.mReceived), static_cast<double>(point.mLost),
+        lossPercent(point), point.mDeliveredHz, point.mCpuNsPerSample, point.mPublisherCpuNs,
+        us(point.mCycleTime.getPercentile(50.0)), us(point.mCycleTime.getPercentile(99.0)), us(point.mCycleTime.getMax()),
+        us(point.mLateness.getPercentile(99.0)), us(point.mTransportLatency.getPercentile(50.0)),
+        us(point.mTransportLatency.getPercentile(99.0)), us(point.mTransportLatency.getPercentile(99.9)),
+        us(point.mTransportLatency.getMax()), us(point.mEndToEndLatency.getPercentile(50.0)),
+        us(point.mEndToEndLatency.getPercentile(99.0)), us(point.mEndToEndLatency.getMax())
+    };
+    constexpr size_t FIRST_VALUE = 5;
+    constexpr size_t VALUES = sizeof(values) / sizeof(values[0]);
+    static_assert(FIRST_VALUE + VALUES == sizeof(COLUMNS) / sizeof(COLUMNS[0]), "one value per column");
+    for (size_t i = 0; i < VALUES; ++i)
+    {
+        const bool last = i + 1 == VALUES;
+        if (csv)
+        {
+            fprintf(file, "%.10g%s", values[i], last ? "\n" : ",");
+        }
+        else
+        {
+            fprintf(file, "\"%s\": %.10g%s", COLUMNS[FIRST_VALUE + i], values[i], last ? "}" : ", ");
+        }
+    }
+}
+
+bool parseList(const std::string& text, std::vector<int>& values)
+{
+    values.clear();
+    std::stringstream stream(text);
+    std::string item;
+    while (std::getline(stream, item, ','))
+    {
+        const int value = std::stoi(item);
+        if (value <= 0)
+        {
+            return false;
+        }
+        values.push_back(value);
+    }
+    return !values.empty();
+}
+
+void printUsage(const char* programName)
+{
+    std::cerr << "Usage: " << programName << " [options] [-- publisher and subscriber options]\n"
+              << "Options:\n"
+              << "  --rates        : Comma separated publishing rates in Hz (default 100,1000,10000,50000)\n"
+              << "  --subscribers  : Comma separated subscriber counts (default 1,10,100,1000)\n"
+              << "  --duration-ms  : Time every subscriber receives for, per point (default 2000)\n"
+              << "  --output       : Report path (default stdout)\n"
+              << "  --format       : Report format (json or csv, default json)\n"
+              << "  --label        : Text copied to every row of the report\n"
+              << "Options after -- are those of the publisher and subscriber, for instance --transport shm\n";
+}
+
+bool parseOptions(int argc, char* argv[], Options& options)
+{
+    constexpr struct option long_options[] = {
+        {"rates", required_argument, 0, 'f'},
+        {"subscribers", required_argument, 0, 'n'},
+        {"duration-ms", required_argument, 0, 'd'},
+        {"output", required_argument, 0, 'o'},
+        {"format", required_argument, 0, 'F'},
+        {"label", required_argument, 0, 'L'},
+        {0, 0, 0, 0}
+    };
+
+    int opt;
+    while ((opt = getopt_long(argc, argv, "f:n:d:o:F:L:", long_options, nullptr)) != -1)
+    {
+        switch (opt)
+        {
+            case 'f':
+                if (!parseList(optarg, options.mRates))
+                {
+                    spdlog::error("Invalid rates (must be positive integers): {}", optarg);
+                    return false;
+                }
+                break;
+            case 'n':
+                if (!parseList(optarg, options.mSubscribers))
+                {
+                    spdlog::error("Invalid subscriber counts (must be positive integers): {}", optarg);
+                    return false;
+                }
+                break;
+            case 'd':
+                options.mDurationMs = std::stol(optarg);
+                if (options.mDurationMs <= 0)
+                {
+                    spdlog::error("Invalid duration (must be positive): {}", options.mDurationMs);
+                    return false;
+                }
+                break;
+            case 'o':
+                options.mOutput = optarg;
+                break;
+            case 'F':
+                if (std::string(optarg) != "json" && std::string(optarg) != "csv")
+                {
+                    spdlog::error("Invalid format (must be json or csv): {}", optarg);
+                    return false;
+                }
+                options.mCsv = std::string(optarg) == "csv";
+                break;
+            case 'L':
+                options.mLabel = optarg;
+                break;
+            default:
+                return false;
+        }
+    }
+    return true;
+}
+} // end of anonymous namespace
+
+int main(int argc, char* argv[])
+{
+    // The report may go to stdout, everything else goes to stderr
+    spdlog::set_default_logger(spdlog::stderr_color_mt("bench"));
+    setupLogger("WARN");
+
+    // Split the arguments at "--", the second part is parsed like the publisher and subscriber options
+    int split = argc;
+    for (int i = 1; i < argc; ++i)
+    {
+        if (strcmp(argv[i], "--") == 0)
+        {
+            split = i;
+            break;
+        }
+    }
+
+    Options options{{100, 1000, 10000, 50000}, {1, 10, 100, 1000}, 2000, "", false, ""};
+    if (!parseOptions(split, argv, options))
+    {
+        printUsage(argv[0]);
+        return 1;
+    }
+
+    char directory[] = "/tmp/imu_transport_bench.XXXXXX";
+    if (mkdtemp(directory) == nullptr)
+    {
+        spdlog::error("Failed to create the socket directory: {}", strerror(errno));
+        return 1;
+    }
+    std::vector<char*> transportArgs = {argv[0], const_cast<char*>("--socket-path"), directory};
+    for (int i = split + 1; i < argc; ++i)
+    {
+        transportArgs.push_back(argv[i]);
+    }
+    transportArgs.push_back(nullptr);
+
+    Parameters params;
+    params.mTimeoutMs = DEFAULT_TIMEOUT_MS;
+    optind = 1;
+    if (!parseParameters(static_cast<int>(transportArgs.size()) - 1, transportArgs.data(), params))
+    {
+        printUsage(argv[0]);
+        std::filesystem::remove_all(directory);
+        return 1;
+    }
+    // Subscribers of one host share the group port
+    params.mReusePort = true;
+
+    // Publisher and subscribers stay at WARN unless --log-level is given, the progress is always shown
+    auto progress = spdlog::stderr_color_mt("imu_transport_bench");
+    progress->set_level(spdlog::level::info);
+
+    FILE* file = options.mOutput.empty() ? stdout : fopen(options.mOutput.c_str(), "w");
+    if (file == nullptr)
+    {
+        spdlog::error("Failed to open {}: {}", options.mOutput, strerror(errno));
+        std::filesystem::remove_all(directory);
+        return 1;
+    }
+    if (options.mCsv)
+    {
+        for (size_t i = 0; i < sizeof(COLUMNS) / sizeof(COLUMNS[0]); ++i)
+        {
+            fprintf(file, "%s%s", i > 0 ? "," : "", COLUMNS[i]);
+        }
+        fprintf(file, "\n");
+    }
+    else
+    {
+        fprintf(file, "{\n  \"benchmark\": \"imu_transport_bench\",\n  \"duration_ms\": %ld,\n  \"online_cpus\": %ld,\n"
+                "  \"results\": [\n", options.mDurationMs, sysconf(_SC_NPROCESSORS_ONLN));
+    }
+
+    bool first = true;
+    for (const int rateHz : options.mRates)
+    {
+        for (const int subscribers : options.mSubscribers)
+        {
+            Point point;
+            if (!runPoint(options, params, rateHz, subscribers, point))
+            {
+                spdlog::error("Point at {} Hz with {} subscribers failed", rateHz, subscribers);
+            }
+            if (!options.mCsv && !first)
+            {
+                fprintf(file, ",\n");
+            }
+            writeRow(file, options.mCsv, options, params, point);
+            fflush(file);
+            first = false;
+            progress->info("{} Hz, {} subscribers: delivered {:.1f} Hz, loss {:.3f}%, latency p99 {:.1f} us, "
+                         "{:.0f} CPU ns/sample, {} failed",
+                         rateHz, subscribers, point.mDeliveredHz, lossPercent(point),
+                         point.mTransportLatency.getPercentile(99.0) / 1e3, point.mCpuNsPerSample, point.mFailed);
+        }
+    }
+
+    if (!options.mCsv)
+    {
+        fprintf(file, "\n  ]\n}\n");
+    }
+    if (file != stdout)
+    {
+        fclose(file);
+    }
+    std::filesystem::remove_all(directory);
+    return 0;
+}
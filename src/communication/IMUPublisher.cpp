@@ -1,37 +1,145 @@
+#include <cmath>
 #include <filesystem>
+#include <sstream>
 #include <spdlog/spdlog.h>
+#include <sys/epoll.h>
 #include <sys/socket.h>
+#include <sys/timerfd.h>
 #include <sys/un.h>
+#include <unistd.h>
 
 #include "communication/IMUPublisher.h"
-#include "core/PayloadIMU.h"
+#include "core/FrameIMU.h"
+#include "core/Protocol.h"
 
 namespace
 {
 inline constexpr long NSEC_PER_SEC = 1000000000L;
+inline constexpr long NSEC_PER_MSEC = 1000000L;
+inline constexpr uint32_t SHM_RING_CAPACITY = 4096;
+inline constexpr int MAX_EPOLL_EVENTS = 2;
+inline constexpr unsigned URING_SEND_ENTRIES = 256;
+inline constexpr long MAX_CATCH_UP_NS = NSEC_PER_SEC; ///< Longest backlog run back-to-back with OverrunPolicy::CATCH_UP
 
-class ScopedLock
+inline long toNs(const struct timespec& ts)
 {
-public:
-    explicit ScopedLock(pthread_mutex_t& lock) : mLock(lock)
+    return ts.tv_sec * NSEC_PER_SEC + ts.tv_nsec;
+}
+
+inline struct timespec toTimespec(const long ns)
+{
+    struct timespec ts;
+    ts.tv_sec = ns / NSEC_PER_SEC;
+    ts.tv_nsec = ns % NSEC_PER_SEC;
+    return ts;
+}
+
+/**
+ * @brief Parse the optional rate and mode fields of a registration message
+ */
+void parseRegistration(const char* message, int& rateHz, RateMode& rateMode)
+{
+    std::istringstream fields(message);
+    std::string field;
+    while (fields >> field)
     {
-        pthread_mutex_lock(&mLock);
+        if (field.compare(0, strlen(REG_RATE_FIELD), REG_RATE_FIELD) == 0)
+        {
+            rateHz = atoi(field.c_str() + strlen(REG_RATE_FIELD));
+        }
+        else if (field.compare(0, strlen(REG_MODE_FIELD), REG_MODE_FIELD) == 0)
+        {
+            rateMode = field.compare(strlen(REG_MODE_FIELD), std::string::npos, "average") == 0
+                ? RateMode::AVERAGE : RateMode::DECIMATE;
+        }
     }
+}
 
-    virtual ~ScopedLock()
+/**
+ * @brief Add the measurements of a sample to a running sum
+ */
+inline void accumulate(Payload_IMU_t& sum, const Payload_IMU_t& sample)
+{
+    sum.xAcc += sample.xAcc;
+    sum.yAcc += sample.yAcc;
+    sum.zAcc += sample.zAcc;
+    sum.xGyro += sample.xGyro;
+    sum.yGyro += sample.yGyro;
+    sum.zGyro += sample.zGyro;
+    sum.xMag += sample.xMag;
+    sum.yMag += sample.yMag;
+    sum.zMag += sample.zMag;
+}
+
+/**
+ * @brief Turn a running sum into a mean, timestamps are taken from the latest sample
+ */
+inline void average(Payload_IMU_t& mean, const Payload_IMU_t& sum, const Payload_IMU_t& latest, const uint32_t count)
+{
+    const float scale = 1.0f / static_cast<float>(count);
+    mean.xAcc = sum.xAcc * scale;
+    mean.yAcc = sum.yAcc * scale;
+    mean.zAcc = sum.zAcc * scale;
+    mean.timestampAcc = latest.timestampAcc;
+    mean.xGyro = sum.xGyro * scale;
+    mean.yGyro = sum.yGyro * scale;
+    mean.zGyro = sum.zGyro * scale;
+    mean.timestampGyro = latest.timestampGyro;
+    mean.xMag = sum.xMag * scale;
+    mean.yMag = sum.yMag * scale;
+    mean.zMag = sum.zMag * scale;
+    mean.timestampMag = latest.timestampMag;
+    mean.acquisitionNs = latest.acquisitionNs;
+}
+
+/**
+ * @brief Set the publish time of all samples of a frame
+ */
+inline void stampFrame(Frame_IMU_t& frame, const uint64_t publishNs)
+{
+    for (uint16_t i = 0; i < frame.header.sampleCount; ++i)
     {
-        pthread_mutex_unlock(&mLock);
+        frame.samples[i].publishNs = publishNs;
     }
+}
 
-private:
-    pthread_mutex_t& mLock;
-};
+/**
+ * @brief Get the frame sent to a subscriber, its own one when its rate is reduced
+ */
+inline Frame_IMU_t& frameOf(SubscriberRegistry::Subscriber& subscriber, Frame_IMU_t& shared)
+{
+    return subscriber.mFrame ? *subscriber.mFrame : shared;
+}
 } // end of anonymous namespace
 
 IMUPublisher::IMUPublisher(IMUDataProvider& dataProvider) 
 : IMUSocketHandler(),
   mDataProvider(dataProvider),
-  mPeriodNs(0)
+  mPeriodNs(0),
+  mEpoll(-1),
+  mTimer(-1),
+  mControlSocket(-1),
+  mMulticastSocket(-1),
+  mRegistry(),
+  mRing(),
+  mMessages(),
+  mTargets(),
+  mReduced(),
+  mFullRateCount(0),
+  mFrameIov{&mFrame, 0},
+  mSyscallsSaved(0),
+  mPendingCount(0),
+  mGroupSent(0),
+  mGroupFailed(0),
+  mFrame(),
+  mFrameStartNs(0),
+  mNextSequence(0),
+  mNextStatsNs(0),
+  mLateness(),
+  mCycleTime(),
+  mNextReportNs(0),
+  mOverruns(0),
+  mSkipped(0)
 {
 }
 
@@ -53,144 +161,788 @@ bool IMUPublisher::initialise(const Parameters& params)
     }
     
     disconnect();
-    return setupSocket(params.mSocketPath);
+    if (!setupSocket(params.mSocketPath))
+    {
+        return false;
+    }
+
+    // Registrations go to their own socket when asked, so that their traffic cannot queue up with data
+    if (!params.mControlSocketPath.empty())
+    {
+        mControlSocket = bindSocket(params.mControlSocketPath);
+        if (mControlSocket < 0)
+        {
+            return false;
+        }
+    }
+
+    if (!setupEventLoop())
+    {
+        return false;
+    }
+
+    // Only the socket transports send data, the ring transports have nothing to hand to io_uring
+    if (!isRingTransport(params.mTransport))
+    {
+        setupIoBackend(URING_SEND_ENTRIES);
+    }
+
+    // The socket is only used for the registration handshake with the shared memory transports
+    if (params.mTransport == TransportType::SHM)
+    {
+        return mRing.create("/imu_ring_" + std::to_string(getpid()), SHM_RING_CAPACITY);
+    }
+    if (params.mTransport == TransportType::MEMFD)
+    {
+        return mRing.createMemfd("imu_ring", SHM_RING_CAPACITY);
+    }
+
+    // Frames go to the multicast group, registered subscribers still get their own copy
+    if (params.mTransport == TransportType::UDP)
+    {
+        mMulticastSocket = setupMulticastSocket(params, true);
+        return mMulticastSocket >= 0;
+    }
+    return true;
+}
+
+bool IMUPublisher::setupEventLoop()
+{
+    mEpoll = epoll_create1(EPOLL_CLOEXEC);
+    mTimer = timerfd_create(CLOCK_MONOTONIC, TFD_CLOEXEC | TFD_NONBLOCK);
+    if (mEpoll < 0 || mTimer < 0)
+    {
+        spdlog::error("Failed to create the publisher event loop: {}", strerror(errno));
+        return false;
+    }
+
+    struct epoll_event event;
+    event.events = EPOLLIN;
+    event.data.fd = mTimer;
+    if (epoll_ctl(mEpoll, EPOLL_CTL_ADD, mTimer, &event) < 0)
+    {
+        spdlog::error("Failed to watch the publish timer: {}", strerror(errno));
+        return false;
+    }
+
+    event.events = EPOLLIN;
+    event.data.fd = registrationSocket();
+    if (epoll_ctl(mEpoll, EPOLL_CTL_ADD, registrationSocket(), &event) < 0)
+    {
+        spdlog::error("Failed to watch the registration socket: {}", strerror(errno));
+        return false;
+    }
+    return true;
 }
 
 void IMUPublisher::threadBody()
 {
-    Payload_IMU_t imuData;
-    struct timespec startTime;
-    struct timespec endTime;
-    struct timespec sleepTime;
-    long processingTimeNs;
-    long sleepTimeNs;
-    pthread_mutexattr_t mutexAttr;
-
-    pthread_mutexattr_init(&mutexAttr);
-    
-    // Enable priority inheritance for real-time operation
-    if (mParameters.mRealTime)
+    struct epoll_event events[MAX_EPOLL_EVENTS];
+    struct timespec now;
+
+    // The first cycle runs straight away, the following ones on the absolute deadlines of the timer
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    long deadlineNs = toNs(now);
+    mNextReportNs = deadlineNs + NSEC_PER_SEC;
+
+    struct itimerspec timerSpec;
+    timerSpec.it_value = now;
+    timerSpec.it_interval = toTimespec(mPeriodNs);
+    if (timerfd_settime(mTimer, TFD_TIMER_ABSTIME, &timerSpec, nullptr) < 0)
     {
-        pthread_mutexattr_setprotocol(&mutexAttr, PTHREAD_PRIO_INHERIT);
+        spdlog::error("Failed to arm the publish timer: {}", strerror(errno));
+        return;
     }
-    
-    pthread_mutex_init(&mSubscribersMutex, &mutexAttr);
 
     while (isRunning())
     {
-        // Get time at the start of the loop
-        clock_gettime(CLOCK_MONOTONIC, &startTime);
-        
-        // Check for new subscriber registrations
-        checkForRegistrations();
-        
-        // Get IMU data from the provider
-        mDataProvider.getIMUData(imuData);
-        
-        // Send data to all subscribers
-        sendData(imuData);
-        
-        // Get time after data was generated and published
-        clock_gettime(CLOCK_MONOTONIC, &endTime);
-        
-        // Calculate processing time
-        processingTimeNs = (endTime.tv_sec - startTime.tv_sec) * NSEC_PER_SEC + 
-                           (endTime.tv_nsec - startTime.tv_nsec);
-        
-        // Calculate sleep time by subtracting processing time from period
-        sleepTimeNs = mPeriodNs - processingTimeNs;
-        if (sleepTimeNs > 0)
+        int ready = epoll_wait(mEpoll, events, MAX_EPOLL_EVENTS, -1);
+        if (ready < 0)
         {
-            sleepTime.tv_sec = sleepTimeNs / NSEC_PER_SEC;
-            sleepTime.tv_nsec = sleepTimeNs % NSEC_PER_SEC;
-            clock_nanosleep(CLOCK_MONOTONIC, 0, &sleepTime, nullptr);
+            if (errno == EINTR)
+            {
+                continue;
+            }
+            spdlog::error("Publisher event loop failed: {}", strerror(errno));
+            break;
         }
-        else
+
+        bool tick = false;
+        bool registration = false;
+        for (int i = 0; i < ready; ++i)
         {
-            spdlog::warn("Processing time exceeded period by {} us", -sleepTimeNs / 1000);
+            tick |= events[i].data.fd == mTimer;
+            registration |= events[i].data.fd != mTimer;
+        }
+
+        // The data plane goes first, registrations never delay a due sample
+        if (tick)
+        {
+            // Consume the expiries, the deadlines themselves are tracked here so that
+            // ticks already served by catching up do not run again
+            uint64_t expirations;
+            if (read(mTimer, &expirations, sizeof(expirations)) < 0 && errno != EAGAIN)
+            {
+                spdlog::error("Failed to read the publish timer: {}", strerror(errno));
+            }
+            // A publisher that cannot keep up still returns to the loop to serve registrations
+            clock_gettime(CLOCK_MONOTONIC, &now);
+            const long maxCycles = std::max(1L, MAX_CATCH_UP_NS / mPeriodNs);
+            for (long cycles = 0; isRunning() && toNs(now) >= deadlineNs && cycles < maxCycles; ++cycles)
+            {
+                deadlineNs = publishCycle(deadlineNs, now);
+            }
+        }
+        if (registration)
+        {
+            checkForRegistrations();
         }
     }
     
-    pthread_mutex_destroy(&mSubscribersMutex);
-    pthread_mutexattr_destroy(&mutexAttr);
+    if (!isRingTransport(mParameters.mTransport))
+    {
+        // Do not lose samples still waiting in a partially filled frame
+        if (mFrame.header.sampleCount > 0)
+        {
+            sendData();
+        }
+        spdlog::info("Batched fan-out saved {} send syscalls", mSyscallsSaved);
+        logSubscribersStats();
+    }
+
+    logTimingStats();
+}
+
+long IMUPublisher::publishCycle(long deadlineNs, struct timespec& now)
+{
+    Payload_IMU_t imuData;
+    const long startNs = toNs(now);
+    mLateness.record(std::max(0L, startNs - deadlineNs));
+
+    // Drop the subscribers evicted by the previous cycles
+    sweepSubscribers();
+
+    // Get IMU data from the provider
+    mDataProvider.getIMUData(imuData);
+
+    // Send data to all subscribers
+    if (isRingTransport(mParameters.mTransport))
+    {
+        struct timespec publishTime;
+        clock_gettime(CLOCK_MONOTONIC, &publishTime);
+        imuData.publishNs = toNs(publishTime);
+        mRing.write(imuData);
+    }
+    else
+    {
+        queueSample(imuData, now);
+    }
+
+    // Get time after data was generated and published
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    const long endNs = toNs(now);
+    mCycleTime.record(endNs - startNs);
+    logStats(endNs);
+
+    // Compute the next deadline and handle a missed period
+    deadlineNs += mPeriodNs;
+    if (endNs > deadlineNs)
+    {
+        ++mOverruns;
+        if (mParameters.mOverrunPolicy == OverrunPolicy::SKIP)
+        {
+            const long missed = (endNs - deadlineNs) / mPeriodNs + 1;
+            deadlineNs += missed * mPeriodNs;
+            mSkipped += missed;
+        }
+        else if (endNs - deadlineNs > MAX_CATCH_UP_NS)
+        {
+            // Catching up is bounded, the periods beyond the longest backlog are skipped
+            const long missed = (endNs - deadlineNs - MAX_CATCH_UP_NS) / mPeriodNs + 1;
+            deadlineNs += missed * mPeriodNs;
+            mSkipped += missed;
+        }
+    }
+
+    // Overruns are reported once per second, logging each of them would only cause more
+    if (endNs >= mNextReportNs)
+    {
+        if (mOverruns > 0)
+        {
+            spdlog::warn("{} overruns in the last second, {} periods skipped", mOverruns, mSkipped);
+        }
+        mOverruns = 0;
+        mSkipped = 0;
+        mNextReportNs = endNs + NSEC_PER_SEC;
+    }
+    return deadlineNs;
 }
 
 void IMUPublisher::disconnect()
 {
     IMUSocketHandler::disconnect();
+    mRing.close();
+
+    for (int* fd : {&mEpoll, &mTimer, &mControlSocket, &mMulticastSocket})
+    {
+        if (*fd >= 0)
+        {
+            close(*fd);
+            *fd = -1;
+        }
+    }
     
-    if (!mParameters.mSocketPath.empty() && std::filesystem::exists(mParameters.mSocketPath))
+    for (const std::string& path : {mParameters.mSocketPath, mParameters.mControlSocketPath})
     {
-        spdlog::info("Unlinking existing socket at {}", mParameters.mSocketPath);
-        std::filesystem::remove(mParameters.mSocketPath);
+        if (!path.empty() && std::filesystem::exists(path))
+        {
+            spdlog::info("Unlinking existing socket at {}", path);
+            std::filesystem::remove(path);
+        }
     }
 }
 
 void IMUPublisher::checkForRegistrations()
 {
     struct sockaddr_un client_addr;
-    socklen_t addrlen = sizeof(client_addr);
-    char buffer[10];
-    
-    // Non-blocking receive to check for registrations
-    ssize_t bytes_read = recvfrom(mSocket, buffer, sizeof(buffer), MSG_DONTWAIT,
-                                 reinterpret_cast<struct sockaddr*>(&client_addr), &addrlen);
+    socklen_t addrlen;
+    char buffer[CONTROL_MSG_SIZE];
+    ssize_t bytes_read;
     
-    if (bytes_read > 0)
+    // Drain every queued registration, a burst is admitted in one go
+    while (true)
     {
-        // Got a registration message
-        ScopedLock lock(mSubscribersMutex);
+        addrlen = sizeof(client_addr);
+        bytes_read = recvfrom(registrationSocket(), buffer, sizeof(buffer) - 1, MSG_DONTWAIT,
+                              reinterpret_cast<struct sockaddr*>(&client_addr), &addrlen);
+        if (bytes_read < 0)
+        {
+            if (errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR)
+            {
+                spdlog::error("Failed to receive registration: {}", strerror(errno));
+            }
+            break;
+        }
         
-        // Check if this subscriber is already registered
-        bool found = false;
-        for (const auto& addr : mSubscribers)
+        if (bytes_read > 0 && isRingTransport(mParameters.mTransport))
         {
-            if (strcmp(addr.sun_path, client_addr.sun_path) == 0)
+            // Hand out the segment name, subscribers read the ring on their own
+            replyWithSegment(client_addr);
+        }
+        else if (bytes_read > 0)
+        {
+            buffer[bytes_read] = '\0';
+            int rateHz = 0;
+            RateMode rateMode = RateMode::DECIMATE;
+            parseRegistration(buffer, rateHz, rateMode);
+
+            const uint32_t divider = rateDivider(mParameters.mFrequencyHz, rateHz);
+
+            SubscriberRegistry::Subscriber* subscriber = mRegistry.add(client_addr, divider, rateMode);
+            if (subscriber != nullptr)
             {
-                found = true;
-                break;
+                // Got a registration message from a new subscriber
+                attachSubscriber(*subscriber);
+                spdlog::info("New subscriber registered: {} at {:.1f} Hz{}", client_addr.sun_path,
+                             static_cast<double>(mParameters.mFrequencyHz) / divider,
+                             divider == 1 ? "" : rateMode == RateMode::AVERAGE ? " (average)" : " (decimate)");
             }
         }
-        // The subscriber was not found so add it to the list
-        if (!found)
+    }
+}
+
+void IMUPublisher::sweepSubscribers()
+{
+    if (!mRegistry.hasEvictions())
+    {
+        return;
+    }
+    for (const auto& subscriber : mRegistry.sweep())
+    {
+        detachSubscriber(*subscriber);
+        if (subscriber->mHasPending)
         {
-            mSubscribers.push_back(client_addr);
-            spdlog::info("New subscriber registered: {}", client_addr.sun_path);
+            --mPendingCount;
         }
+        logSubscriberStats(*subscriber);
     }
 }
 
-void IMUPublisher::sendData(const Payload_IMU_t& imuData)
+void IMUPublisher::replyWithSegment(const struct sockaddr_un& clientAddr)
 {
-    ssize_t bytes_sent;
-    ScopedLock lock(mSubscribersMutex);
-    for (auto it = mSubscribers.begin(); it != mSubscribers.end(); )
+    std::string reply = std::string(SHM_MSG) + mRing.getName();
+    struct iovec iov;
+    struct msghdr msg;
+    union
     {
-        bytes_sent = sendto(mSocket, &imuData, sizeof(Payload_IMU_t), 0, 
-            reinterpret_cast<const struct sockaddr*>(&(*it)), sizeof(*it));
-        
-        if (bytes_sent < 0)
+        char mBuffer[CMSG_SPACE(sizeof(int))];
+        struct cmsghdr mAlign;
+    } control;
+
+    memset(&msg, 0, sizeof(msg));
+    msg.msg_name = const_cast<struct sockaddr_un*>(&clientAddr);
+    msg.msg_namelen = sizeof(clientAddr);
+    msg.msg_iov = &iov;
+    msg.msg_iovlen = 1;
+
+    if (mParameters.mTransport == TransportType::MEMFD)
+    {
+        // The subscriber gets its own descriptor of the ring, there is no name to open
+        reply = MEMFD_MSG;
+        const int fd = mRing.getFd();
+        memset(&control, 0, sizeof(control));
+        msg.msg_control = control.mBuffer;
+        msg.msg_controllen = sizeof(control.mBuffer);
+        struct cmsghdr* cmsg = CMSG_FIRSTHDR(&msg);
+        cmsg->cmsg_level = SOL_SOCKET;
+        cmsg->cmsg_type = SCM_RIGHTS;
+        cmsg->cmsg_len = CMSG_LEN(sizeof(int));
+        memcpy(CMSG_DATA(cmsg), &fd, sizeof(int));
+    }
+    iov.iov_base = reply.data();
+    iov.iov_len = reply.size();
+
+    if (sendmsg(registrationSocket(), &msg, 0) < 0)
+    {
+        spdlog::error("Failed to send shared memory segment to {}: {}", clientAddr.sun_path, strerror(errno));
+    }
+    else
+    {
+        spdlog::info("New shared memory subscriber registered: {}", clientAddr.sun_path);
+    }
+}
+
+void IMUPublisher::queueSample(const Payload_IMU_t& imuData, const struct timespec& now)
+{
+    const long nowNs = toNs(now);
+    if (mFrame.header.sampleCount == 0)
+    {
+        mFrame.header.version = FRAME_VERSION;
+        mFrame.header.sequence = mNextSequence;
+        mFrameStartNs = nowNs;
+    }
+    mFrame.samples[mFrame.header.sampleCount++] = imuData;
+    ++mNextSequence;
+
+    for (SubscriberRegistry::Subscriber* subscriber : mReduced)
+    {
+        reduceSample(*subscriber, imuData);
+    }
+
+    // Flush when the frame is full or its oldest sample has waited long enough
+    if (mFrame.header.sampleCount >= mParameters.mBatchSize ||
+        (mParameters.mMaxBatchLatencyUs > 0 && nowNs - mFrameStartNs >= mParameters.mMaxBatchLatencyUs * 1000))
+    {
+        sendData();
+    }
+}
+
+void IMUPublisher::reduceSample(SubscriberRegistry::Subscriber& subscriber, const Payload_IMU_t& imuData)
+{
+    if (subscriber.mRateMode == RateMode::AVERAGE)
+    {
+        accumulate(subscriber.mAccumulator, imuData);
+    }
+    if (++subscriber.mPhase < subscriber.mDivider)
+    {
+        return;
+    }
+
+    // A reduced frame never outgrows the shared one since both are flushed together
+    Frame_IMU_t& frame = *subscriber.mFrame;
+    if (frame.header.sampleCount == 0)
+    {
+        frame.header.version = FRAME_VERSION;
+        frame.header.sequence = subscriber.mNextSequence;
+    }
+    Payload_IMU_t& output = frame.samples[frame.header.sampleCount++];
+    if (subscriber.mRateMode == RateMode::AVERAGE)
+    {
+        average(output, subscriber.mAccumulator, imuData, subscriber.mDivider);
+        subscriber.mAccumulator = Payload_IMU_t();
+    }
+    else
+    {
+        output = imuData;
+    }
+    ++subscriber.mNextSequence;
+    subscriber.mPhase = 0;
+}
+
+void IMUPublisher::attachSubscriber(SubscriberRegistry::Subscriber& subscriber)
+{
+    if (subscriber.mFrame)
+    {
+        subscriber.mSlot = mReduced.size();
+        mReduced.push_back(&subscriber);
+        return;
+    }
+
+    // Full rate messages lead the array, drop the reduced-rate ones appended by the last fan-out
+    mMessages.resize(mFullRateCount);
+    mTargets.resize(mFullRateCount);
+    subscriber.mSlot = mFullRateCount++;
+    appendMessage(subscriber, &mFrameIov);
+}
+
+void IMUPublisher::detachSubscriber(const SubscriberRegistry::Subscriber& subscriber)
+{
+    // The last entry takes the place of the removed one
+    if (subscriber.mFrame)
+    {
+        mReduced[subscriber.mSlot] = mReduced.back();
+        mReduced[subscriber.mSlot]->mSlot = subscriber.mSlot;
+        mReduced.pop_back();
+        return;
+    }
+
+    mMessages.resize(mFullRateCount);
+    mTargets.resize(mFullRateCount);
+    mMessages[subscriber.mSlot] = mMessages.back();
+    mTargets[subscriber.mSlot] = mTargets.back();
+    mTargets[subscriber.mSlot]->mSlot = subscriber.mSlot;
+    mMessages.pop_back();
+    mTargets.pop_back();
+    --mFullRateCount;
+}
+
+void IMUPublisher::appendMessage(SubscriberRegistry::Subscriber& subscriber, struct iovec* iov)
+{
+    struct mmsghdr message;
+    memset(&message, 0, sizeof(struct mmsghdr));
+    message.msg_hdr.msg_name = &subscriber.mAddress;
+    message.msg_hdr.msg_namelen = sizeof(struct sockaddr_un);
+    message.msg_hdr.msg_iov = iov;
+    message.msg_hdr.msg_iovlen = 1;
+    mMessages.push_back(message);
+    mTargets.push_back(&subscriber);
+}
+
+void IMUPublisher::sendData()
+{
+    // Full rate subscribers share mFrame, reduced rate ones are only sent a frame when it holds samples
+    mMessages.resize(mFullRateCount);
+    mTargets.resize(mFullRateCount);
+    for (SubscriberRegistry::Subscriber* subscriber : mReduced)
+    {
+        if (subscriber->mFrame->header.sampleCount > 0)
         {
-            if (errno == ENOENT || errno == ECONNREFUSED)
+            subscriber->mFrameIov.iov_len = frameSize(subscriber->mFrame->header.sampleCount);
+            appendMessage(*subscriber, &subscriber->mFrameIov);
+        }
+    }
+    mFrameIov.iov_len = frameSize(mFrame.header.sampleCount);
+    const size_t count = mMessages.size();
+
+    // Stamp the samples right before they are handed to the kernel
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    stampFrame(mFrame, toNs(now));
+    for (SubscriberRegistry::Subscriber* subscriber : mReduced)
+    {
+        stampFrame(*subscriber->mFrame, toNs(now));
+    }
+
+    // A single datagram reaches every member of the multicast group
+    if (mMulticastSocket >= 0)
+    {
+        sendToGroup();
+    }
+
+    // Samples kept for slow subscribers go out first so that ordering is preserved
+    if (mPendingCount > 0)
+    {
+        retryPending();
+    }
+
+    if (mUring.isOpen())
+    {
+        sendWithUring(count);
+    }
+    else
+    {
+        // Non-blocking sends: a full subscriber socket must never stall the publisher.
+        // sendmmsg() stops at the first failing message, so resume right after it
+        size_t syscalls = 0;
+        size_t offset = 0;
+        while (offset < count)
+        {
+            int sent = sendmmsg(mSocket, &mMessages[offset], count - offset, MSG_DONTWAIT);
+            ++syscalls;
+            if (sent < 0)
             {
-                // Subscriber socket no longer exists or connection refused
-                spdlog::warn("Subscriber disconnected: {}", it->sun_path);
-                it = mSubscribers.erase(it);
+                handleSendResult(offset, -errno);
+                ++offset;
                 continue;
             }
-            else
+
+            for (size_t i = offset; i < offset + sent; ++i)
+            {
+                handleSendResult(i, static_cast<int>(mMessages[i].msg_len));
+            }
+            offset += sent;
+        }
+        if (syscalls < count)
+        {
+            mSyscallsSaved += count - syscalls;
+        }
+    }
+
+    mFrame.header.sampleCount = 0;
+    for (SubscriberRegistry::Subscriber* subscriber : mReduced)
+    {
+        subscriber->mFrame->header.sampleCount = 0;
+    }
+}
+
+void IMUPublisher::sendWithUring(const size_t count)
+{
+    // Every message becomes a non-blocking SENDMSG entry, a whole chunk is submitted and
+    // reaped with one io_uring_enter(). A failing message does not hold back the others
+    size_t syscalls = 0;
+    size_t offset = 0;
+    while (offset < count)
+    {
+        unsigned queued = 0;
+        while (offset + queued < count)
+        {
+            struct io_uring_sqe* sqe = mUring.getSqe();
+            if (sqe == nullptr)
             {
-                spdlog::error("Error sending data: {}", strerror(errno));
+                break;
             }
+            sqe->opcode = IORING_OP_SENDMSG;
+            sqe->fd = mSocket;
+            sqe->addr = reinterpret_cast<uint64_t>(&mMessages[offset + queued].msg_hdr);
+            sqe->len = 1;
+            sqe->msg_flags = MSG_DONTWAIT;
+            sqe->user_data = offset + queued;
+            ++queued;
         }
-        else if (bytes_sent != sizeof(Payload_IMU_t))
+
+        int retVal = mUring.submit(queued);
+        ++syscalls;
+        while (retVal == -EINTR)
         {
-            spdlog::warn("Warning: Not all bytes were sent");
+            retVal = mUring.submit(queued);
+            ++syscalls;
         }
-        else
+        if (retVal < 0)
         {
-            spdlog::info("Sent {} bytes to {}", bytes_sent, it->sun_path);
+            spdlog::error("Error submitting sends: {}", strerror(-retVal));
+        }
+
+        unsigned reaped = 0;
+        while (reaped < queued)
+        {
+            struct io_uring_cqe* cqe = mUring.peekCqe();
+            if (cqe == nullptr)
+            {
+                // Only possible after an interrupted wait, completions of non-blocking sends are immediate
+                retVal = mUring.submit(queued - reaped);
+                ++syscalls;
+                if (retVal < 0 && retVal != -EINTR)
+                {
+                    spdlog::error("Error waiting for send completions: {}", strerror(-retVal));
+                    break;
+                }
+                continue;
+            }
+            handleSendResult(static_cast<size_t>(cqe->user_data), cqe->res);
+            mUring.seenCqe();
+            ++reaped;
+        }
+        offset += queued;
+    }
+    // Failed sends are retried one at a time and can take more calls than there are messages
+    if (syscalls < count)
+    {
+        mSyscallsSaved += count - syscalls;
+    }
+}
+
+void IMUPublisher::handleSendResult(const size_t index, const int result)
+{
+    SubscriberRegistry::Subscriber& subscriber = *mTargets[index];
+    if (result == -ENOENT || result == -ECONNREFUSED)
+    {
+        // Subscriber socket no longer exists or connection refused
+        if (!subscriber.mEvicted)
+        {
+            spdlog::warn("Subscriber disconnected: {}", subscriber.mAddress.sun_path);
+            mRegistry.markEvicted(subscriber);
+        }
+    }
+    else if (result == -EAGAIN || result == -ENOBUFS)
+    {
+        // The subscriber does not keep up, the samples of this frame are lost for it
+        handleSendFailure(subscriber, frameOf(subscriber, mFrame));
+    }
+    else if (result < 0)
+    {
+        spdlog::error("Error sending data: {}", strerror(-result));
+    }
+    else if (static_cast<size_t>(result) != mMessages[index].msg_hdr.msg_iov->iov_len)
+    {
+        spdlog::warn("Warning: Not all bytes were sent");
+    }
+    else
+    {
+        subscriber.mSent += frameOf(subscriber, mFrame).header.sampleCount;
+        if (subscriber.mHasPending)
+        {
+            // Its retry failed this cycle and it is older than this frame, sending it later would reorder
+            subscriber.mHasPending = false;
+            --mPendingCount;
+        }
+        if (subscriber.mDegraded)
+        {
+            spdlog::info("Subscriber {} recovered after {} failed sends",
+                         subscriber.mAddress.sun_path, subscriber.mConsecutiveFailures);
+            subscriber.mDegraded = false;
+        }
+        subscriber.mConsecutiveFailures = 0;
+        spdlog::info("Sent {} bytes to {}", result, subscriber.mAddress.sun_path);
+    }
+}
+
+void IMUPublisher::sendToGroup()
+{
+    const uint16_t sampleCount = mFrame.header.sampleCount;
+    ssize_t sent = send(mMulticastSocket, &mFrame, mFrameIov.iov_len, MSG_DONTWAIT);
+    if (sent < 0)
+    {
+        mGroupFailed += sampleCount;
+        if (errno != EAGAIN && errno != ENOBUFS)
+        {
+            spdlog::error("Error sending data to the multicast group: {}", strerror(errno));
         }
-        ++it;
     }
-}
\ No newline at end of file
+    else
+    {
+        mGroupSent += sampleCount;
+        spdlog::info("Sent {} bytes to {}:{}", sent, mParameters.mMulticastGroup, mParameters.mMulticastPort);
+    }
+}
+
+void IMUPublisher::handleSendFailure(SubscriberRegistry::Subscriber& subscriber, const Frame_IMU_t& frame)
+{
+    const uint16_t sampleCount = frame.header.sampleCount;
+    subscriber.mFailed += sampleCount;
+    ++subscriber.mConsecutiveFailures;
+    if (!subscriber.mDegraded)
+    {
+        spdlog::warn("Subscriber {} does not keep up, dropping samples", subscriber.mAddress.sun_path);
+        subscriber.mDegraded = true;
+    }
+
+    switch (mParameters.mSlowPolicy)
+    {
+        case SlowSubscriberPolicy::KEEP_LATEST:
+            // Only the newest sample is worth delivering once the subscriber has room again
+            if (!subscriber.mHasPending)
+            {
+                subscriber.mHasPending = true;
+                ++mPendingCount;
+            }
+            subscriber.mPending = frame.samples[sampleCount - 1];
+            subscriber.mPendingSequence = frame.header.sequence + sampleCount - 1;
+            break;
+        case SlowSubscriberPolicy::EVICT:
+            if (subscriber.mConsecutiveFailures >= static_cast<uint32_t>(mParameters.mEvictAfter))
+            {
+                spdlog::warn("Evicting subscriber {} after {} consecutive failed sends",
+                             subscriber.mAddress.sun_path, subscriber.mConsecutiveFailures);
+                mRegistry.markEvicted(subscriber);
+            }
+            break;
+        case SlowSubscriberPolicy::DROP_NEWEST:
+        default:
+            break;
+    }
+}
+
+void IMUPublisher::retryPending()
+{
+    FrameHeader_t header;
+    struct iovec iov[2];
+    struct msghdr msg;
+
+    header.version = FRAME_VERSION;
+    header.sampleCount = 1;
+    iov[0].iov_base = &header;
+    iov[0].iov_len = sizeof(FrameHeader_t);
+    iov[1].iov_len = sizeof(Payload_IMU_t);
+    memset(&msg, 0, sizeof(msg));
+    msg.msg_namelen = sizeof(struct sockaddr_un);
+    msg.msg_iov = iov;
+    msg.msg_iovlen = 2;
+
+    for (const auto& entry : mRegistry.getSubscribers())
+    {
+        SubscriberRegistry::Subscriber* subscriber = entry.second.get();
+        if (!subscriber->mHasPending)
+        {
+            continue;
+        }
+        header.sequence = subscriber->mPendingSequence;
+        iov[1].iov_base = &subscriber->mPending;
+        msg.msg_name = &subscriber->mAddress;
+        // On failure the sample stays pending until it is retried again or overtaken by a delivered frame
+        if (sendmsg(mSocket, &msg, MSG_DONTWAIT) >= 0)
+        {
+            subscriber->mHasPending = false;
+            --mPendingCount;
+            --subscriber->mFailed;
+            ++subscriber->mSent;
+        }
+    }
+}
+
+void IMUPublisher::logSubscriberStats(const SubscriberRegistry::Subscriber& subscriber) const
+{
+    const uint64_t sent = subscriber.mSent;
+    const uint64_t failed = subscriber.mFailed;
+    const uint64_t total = sent + failed;
+    const double failureRate = total > 0 ? 100.0 * static_cast<double>(failed) / total : 0.0;
+    spdlog::info("Subscriber {}: {} samples sent, {} failed ({:.3f}%){}",
+                 subscriber.mAddress.sun_path, sent, failed, failureRate,
+                 subscriber.mDegraded ? ", degraded" : "");
+}
+
+void IMUPublisher::logSubscribersStats()
+{
+    if (mMulticastSocket >= 0)
+    {
+        const uint64_t total = mGroupSent + mGroupFailed;
+        spdlog::info("Multicast group {}:{}: {} samples sent, {} failed ({:.3f}%)",
+                     mParameters.mMulticastGroup, mParameters.mMulticastPort, mGroupSent, mGroupFailed,
+                     total > 0 ? 100.0 * static_cast<double>(mGroupFailed) / total : 0.0);
+    }
+    for (const auto& entry : mRegistry.getSubscribers())
+    {
+        logSubscriberStats(*entry.second);
+    }
+}
+
+void IMUPublisher::logStats(const long nowNs)
+{
+    if (mParameters.mStatsPeriodMs == 0 || nowNs < mNextStatsNs)
+    {
+        return;
+    }
+    if (mNextStatsNs > 0)
+    {
+        logTimingStats();
+        logSubscribersStats();
+    }
+    mNextStatsNs = nowNs + static_cast<long>(mParameters.mStatsPeriodMs) * NSEC_PER_MSEC;
+}
+
+void IMUPublisher::logTimingStats() const
+{
+    spdlog::info("Wakeup lateness: p50 {:.1f} us, p99 {:.1f} us, max {:.1f} us; "
+                 "cycle time: p50 {:.1f} us, p99 {:.1f} us, max {:.1f} us",
+                 mLateness.getPercentile(50.0) / 1e3, mLateness.getPercentile(99.0) / 1e3, mLateness.getMax() / 1e3,
+                 mCycleTime.getPercentile(50.0) / 1e3, mCycleTime.getPercentile(99.0) / 1e3, mCycleTime.getMax() / 1e3);
+}
@@ -1,8 +1,13 @@
 #pragma once
 
 #include <vector>
+#include <sys/socket.h>
+#include "core/FrameIMU.h"
+#include "IMUShmRing.h"
 #include "IMUSocketHandler.h"
+#include "SubscriberRegistry.h"
 #include "providers/IMUDataProvider.h"
+#include "utils/LatencyHistogram.h"
 
 struct Parameters;
 
@@ -43,26 +48,188 @@ public:
      * @brief Thread body implementation for the publisher
      * 
      * This method runs in a separate thread and handles the
-     * periodic publishing of IMU data to subscribers.
+     * periodic publishing of IMU data to subscribers. It waits in
+     * epoll for either the publish timer, which expires on absolute
+     * deadlines, or registrations. Missed periods are either caught up
+     * or skipped according to --overrun-policy.
      */
     void threadBody() override;
 
+    /**
+     * @brief Get the time spent in each publishing cycle, one value per published sample
+     * 
+     * @return The cycle time histogram
+     */
+    inline const LatencyHistogram& getCycleTime() const { return mCycleTime; }
+
+    /**
+     * @brief Get the delay between each publishing deadline and the actual wakeup
+     * 
+     * @return The wakeup lateness histogram
+     */
+    inline const LatencyHistogram& getLateness() const { return mLateness; }
+
 private:
+    /**
+     * @brief Create the epoll instance and the publish timer and watch the registration socket
+     * 
+     * @return true if the event loop is ready
+     */
+    bool setupEventLoop();
+
+    /**
+     * @brief Run one publishing cycle
+     * 
+     * @param deadlineNs Deadline of the cycle in nanoseconds
+     * @param now Start time of the cycle, updated to its end time
+     * @return The deadline of the next cycle in nanoseconds
+     */
+    long publishCycle(long deadlineNs, struct timespec& now);
+
     /**
      * @brief Check for new subscriber registrations
      * 
-     * Listens for registration messages from subscribers and
-     * adds them to the list of active subscribers.
+     * Drains all registration messages queued on the registration
+     * socket and adds their senders to the list of active subscribers.
      */
     void checkForRegistrations();
+
+    /**
+     * @brief Remove the subscribers evicted by the publishing path
+     */
+    void sweepSubscribers();
+
+    /**
+     * @brief Get the socket registrations are received on
+     * 
+     * @return The control socket if --control-socket-path is set, the data socket otherwise
+     */
+    inline int registrationSocket() const { return mControlSocket >= 0 ? mControlSocket : mSocket; }
     
     /**
-     * @brief Send IMU data to all registered subscribers
+     * @brief Reply to a registration with the shared memory segment
+     * 
+     * The reply carries the segment name with the SHM transport and the
+     * memfd itself, as SCM_RIGHTS ancillary data, with the MEMFD transport.
+     * 
+     * @param clientAddr Address of the registering subscriber
+     */
+    void replyWithSegment(const struct sockaddr_un& clientAddr);
+
+    /**
+     * @brief Append a sample to the pending frame and send it if the batching policy says so
+     * 
+     * The frame is sent once it holds --batch-size samples or once its oldest
+     * sample has waited for --max-batch-latency-us.
+     * 
+     * @param imuData The IMU data to queue
+     * @param now The current monotonic time
+     */
+    void queueSample(const Payload_IMU_t& imuData, const struct timespec& now);
+
+    /**
+     * @brief Feed a sample to a reduced-rate subscriber and queue its output when due
+     * 
+     * @param subscriber A subscriber that registered with a rate below --frequency-hz
+     * @param imuData The published IMU sample
+     */
+    void reduceSample(SubscriberRegistry::Subscriber& subscriber, const Payload_IMU_t& imuData);
+
+    /**
+     * @brief Add the fan-out message of a new subscriber, or list it as reduced-rate
+     * 
+     * @param subscriber The subscriber just registered
+     */
+    void attachSubscriber(SubscriberRegistry::Subscriber& subscriber);
+
+    /**
+     * @brief Remove the fan-out message or the reduced-rate entry of a subscriber
      * 
-     * @param imuData The IMU data to send
+     * @param subscriber The subscriber just removed from the registry
      */
-    void sendData(const Payload_IMU_t& imuData);
+    void detachSubscriber(const SubscriberRegistry::Subscriber& subscriber);
+
+    /**
+     * @brief Append a fan-out message to a subscriber
+     * 
+     * @param subscriber The destination subscriber
+     * @param iov The payload of the message
+     */
+    void appendMessage(SubscriberRegistry::Subscriber& subscriber, struct iovec* iov);
+
+    /**
+     * @brief Send the pending frames to all registered subscribers
+     * 
+     * The fan-out is issued as a single non-blocking sendmmsg() call, or as a
+     * batch of io_uring submissions with --io-backend uring, over the
+     * messages kept in step with the registry. Full rate
+     * subscribers share the same frame, reduced-rate subscribers get their own
+     * one. Subscribers that no longer exist are marked for eviction and removed
+     * by the next sweepSubscribers(). All frames are empty afterwards.
+     */
+    void sendData();
     
+    /**
+     * @brief Issue the fan-out messages as io_uring SENDMSG entries
+     * 
+     * Used instead of sendmmsg() with --io-backend uring. All messages are
+     * submitted and their completions reaped with a single io_uring_enter()
+     * per submission queue worth of subscribers.
+     * 
+     * @param count Number of messages in mMessages to send
+     */
+    void sendWithUring(const size_t count);
+
+    /**
+     * @brief Account for the outcome of one fan-out message
+     * 
+     * @param index Index of the message in mMessages
+     * @param result Number of bytes sent, or -errno
+     */
+    void handleSendResult(const size_t index, const int result);
+
+    /**
+     * @brief Send the pending frame to the multicast group with a single non-blocking send()
+     */
+    void sendToGroup();
+
+    /**
+     * @brief Account for a frame a subscriber had no room for and apply --slow-policy
+     * 
+     * @param subscriber The subscriber whose socket buffer is full
+     * @param frame The frame that could not be sent
+     */
+    void handleSendFailure(SubscriberRegistry::Subscriber& subscriber, const Frame_IMU_t& frame);
+
+    /**
+     * @brief Try to deliver the samples kept for slow subscribers
+     */
+    void retryPending();
+
+    /**
+     * @brief Log the delivery counters of a subscriber
+     * 
+     * @param subscriber The subscriber to report
+     */
+    void logSubscriberStats(const SubscriberRegistry::Subscriber& subscriber) const;
+
+    /**
+     * @brief Log the delivery counters of all registered subscribers
+     */
+    void logSubscribersStats();
+
+    /**
+     * @brief Log the delivery counters of all subscribers if the statistics period elapsed
+     * 
+     * @param nowNs The current monotonic time in nanoseconds
+     */
+    void logStats(const long nowNs);
+
+    /**
+     * @brief Log the wakeup lateness and cycle time histograms
+     */
+    void logTimingStats() const;
+
     /**
      * @brief Extended disconnect method to clean up socket files
      */
@@ -70,6 +237,28 @@ private:
 
     IMUDataProvider& mDataProvider;               ///< Source of IMU data
     long mPeriodNs;                               ///< Publishing period in nanoseconds
-    std::vector<struct sockaddr_un> mSubscribers; ///< List of subscriber addresses
-    pthread_mutex_t mSubscribersMutex;            ///< Mutex to protect subscriber list
+    int mEpoll;                                   ///< Event loop waiting for the timer and registrations
+    int mTimer;                                   ///< timerfd expiring on the publishing deadlines
+    int mControlSocket;                           ///< Registration socket, -1 when registrations use mSocket
+    int mMulticastSocket;                         ///< UDP socket connected to the multicast group, -1 otherwise
+    SubscriberRegistry mRegistry;                 ///< Registered subscribers
+    IMUShmRing mRing;                             ///< Shared memory ring used by the SHM transport
+    std::vector<struct mmsghdr> mMessages;        ///< Preallocated message vector for the fan-out
+    std::vector<SubscriberRegistry::Subscriber*> mTargets; ///< Destination of each message in mMessages
+    std::vector<SubscriberRegistry::Subscriber*> mReduced; ///< Subscribers that registered with a reduced rate
+    size_t mFullRateCount;                        ///< Number of leading messages that carry mFrame
+    struct iovec mFrameIov;                       ///< Payload of the full rate messages, points at mFrame
+    uint64_t mSyscallsSaved;                      ///< Number of send syscalls saved by batching
+    size_t mPendingCount;                         ///< Number of subscribers with a sample waiting to be retried
+    uint64_t mGroupSent;                          ///< Number of samples sent to the multicast group
+    uint64_t mGroupFailed;                        ///< Number of samples the multicast socket had no room for
+    Frame_IMU_t mFrame;                           ///< Frame being filled with samples
+    long mFrameStartNs;                           ///< Time the first sample of the frame was queued
+    uint64_t mNextSequence;                       ///< Sequence number of the next queued sample
+    long mNextStatsNs;                            ///< Monotonic time of the next periodic statistics log
+    LatencyHistogram mLateness;                   ///< Delay between a deadline and the actual wakeup
+    LatencyHistogram mCycleTime;                  ///< Time spent in a publishing cycle
+    long mNextReportNs;                           ///< Monotonic time of the next overrun report
+    uint64_t mOverruns;                           ///< Cycles that missed their deadline in the current second
+    uint64_t mSkipped;                            ///< Periods skipped in the current second
 };
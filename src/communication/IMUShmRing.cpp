@@ -0,0 +1,336 @@
+#include <cerrno>
+#include <climits>
+#include <cstring>
+#include <fcntl.h>
+#include <linux/futex.h>
+#include <spdlog/spdlog.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#include "communication/IMUShmRing.h"
+
+namespace
+{
+inline constexpr uint32_t RING_MAGIC = 0x494d5532; // "IMU2", bumped with the sample layout
+inline constexpr uint64_t SLOT_BUSY = UINT64_MAX;
+inline constexpr long NSEC_PER_SEC = 1000000000L;
+
+static_assert(std::atomic<uint64_t>::is_always_lock_free, "Shared memory ring requires lock-free 64-bit atomics");
+static_assert(std::atomic<uint32_t>::is_always_lock_free, "Shared memory ring requires lock-free 32-bit atomics");
+
+/**
+ * @brief Sleep on a shared futex word until it changes or the absolute deadline passes
+ */
+long futexWait(std::atomic<uint32_t>& word, const uint32_t expected, const struct timespec& deadline)
+{
+    return syscall(SYS_futex, reinterpret_cast<uint32_t*>(&word), FUTEX_WAIT_BITSET, expected,
+                   &deadline, nullptr, FUTEX_BITSET_MATCH_ANY);
+}
+
+/**
+ * @brief Wake all processes sleeping on a shared futex word
+ */
+void futexWakeAll(std::atomic<uint32_t>& word)
+{
+    syscall(SYS_futex, reinterpret_cast<uint32_t*>(&word), FUTEX_WAKE, INT_MAX, nullptr, nullptr, 0);
+}
+} // end of anonymous namespace
+
+IMUShmRing::IMUShmRing()
+: mName(""),
+  mOwner(false),
+  mFd(-1),
+  mSize(0),
+  mHeader(nullptr),
+  mSlots(nullptr)
+{
+}
+
+IMUShmRing::~IMUShmRing()
+{
+    close();
+}
+
+bool IMUShmRing::create(const std::string& name, const uint32_t capacity)
+{
+    close();
+
+    int fd = shm_open(name.c_str(), O_CREAT | O_EXCL | O_RDWR, 0600);
+    if (fd < 0)
+    {
+        spdlog::error("Failed to create shared memory segment {}: {}", name, strerror(errno));
+        return false;
+    }
+
+    mName = name;
+    mOwner = true;
+    bool retVal = format(fd, capacity);
+    ::close(fd);
+    if (!retVal)
+    {
+        close();
+        return false;
+    }
+
+    spdlog::info("Created shared memory ring {} with {} slots", mName, capacity);
+    return true;
+}
+
+bool IMUShmRing::createMemfd(const std::string& name, const uint32_t capacity)
+{
+    close();
+
+    int fd = memfd_create(name.c_str(), MFD_CLOEXEC | MFD_ALLOW_SEALING);
+    if (fd < 0)
+    {
+        spdlog::error("Failed to create memfd {}: {}", name, strerror(errno));
+        return false;
+    }
+
+    mName = name;
+    mFd = fd;
+    if (!format(fd, capacity))
+    {
+        close();
+        return false;
+    }
+
+    // Subscribers map the same file, sealing its size protects everybody from SIGBUS on truncation
+    if (fcntl(fd, F_ADD_SEALS, F_SEAL_SHRINK | F_SEAL_GROW | F_SEAL_SEAL) < 0)
+    {
+        spdlog::error("Failed to seal memfd {}: {}", name, strerror(errno));
+        close();
+        return false;
+    }
+
+    spdlog::info("Created memfd ring {} with {} slots", mName, capacity);
+    return true;
+}
+
+bool IMUShmRing::open(const std::string& name)
+{
+    close();
+
+    int fd = shm_open(name.c_str(), O_RDWR, 0);
+    if (fd < 0)
+    {
+        spdlog::error("Failed to open shared memory segment {}: {}", name, strerror(errno));
+        return false;
+    }
+
+    mName = name;
+    bool retVal = attach(fd);
+    ::close(fd);
+    if (!retVal)
+    {
+        close();
+        return false;
+    }
+
+    spdlog::info("Mapped shared memory ring {} with {} slots", mName, mHeader->mCapacity);
+    return true;
+}
+
+bool IMUShmRing::open(const int fd)
+{
+    close();
+
+    // Only a file whose size can no longer change is safe to map
+    const int seals = fcntl(fd, F_GET_SEALS);
+    bool retVal = seals >= 0 && (seals & (F_SEAL_SHRINK | F_SEAL_GROW)) == (F_SEAL_SHRINK | F_SEAL_GROW);
+    if (!retVal)
+    {
+        spdlog::error("Received ring descriptor is not sealed");
+    }
+
+    mName = "memfd:" + std::to_string(fd);
+    retVal = retVal && attach(fd);
+    ::close(fd);
+    if (!retVal)
+    {
+        close();
+        return false;
+    }
+
+    spdlog::info("Mapped memfd ring with {} slots", mHeader->mCapacity);
+    return true;
+}
+
+void IMUShmRing::close()
+{
+    if (mFd >= 0)
+    {
+        ::close(mFd);
+        mFd = -1;
+    }
+    if (mHeader != nullptr)
+    {
+        munmap(mHeader, mSize);
+        mHeader = nullptr;
+        mSlots = nullptr;
+        mSize = 0;
+    }
+    if (mOwner && !mName.empty())
+    {
+        spdlog::info("Unlinking shared memory segment {}", mName);
+        shm_unlink(mName.c_str());
+    }
+    mOwner = false;
+    mName.clear();
+}
+
+void IMUShmRing::write(const Payload_IMU_t& data)
+{
+    const uint64_t index = mHeader->mWriteIndex.load(std::memory_order_relaxed);
+    Slot& slot = mSlots[index % mHeader->mCapacity];
+
+    // Mark the slot busy so that concurrent readers discard what they copy
+    slot.mSequence.store(SLOT_BUSY, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    memcpy(&slot.mData, &data, sizeof(Payload_IMU_t));
+    slot.mSequence.store(index, std::memory_order_release);
+
+    mHeader->mWriteIndex.store(index + 1, std::memory_order_release);
+    mHeader->mFutex.fetch_add(1, std::memory_order_seq_cst);
+    if (mHeader->mWaiters.load(std::memory_order_seq_cst) > 0)
+    {
+        futexWakeAll(mHeader->mFutex);
+    }
+}
+
+bool IMUShmRing::read(uint64_t& cursor, Payload_IMU_t& data) const
+{
+    const uint64_t capacity = mHeader->mCapacity;
+    while (true)
+    {
+        const uint64_t writeIndex = mHeader->mWriteIndex.load(std::memory_order_acquire);
+        if (cursor >= writeIndex)
+        {
+            return false;
+        }
+        if (writeIndex - cursor > capacity)
+        {
+            // Lapped by the writer, jump to the oldest sample that may still be intact
+            cursor = writeIndex - capacity + 1;
+            continue;
+        }
+
+        const Slot& slot = mSlots[cursor % capacity];
+        if (slot.mSequence.load(std::memory_order_acquire) == cursor)
+        {
+            memcpy(&data, &slot.mData, sizeof(Payload_IMU_t));
+            std::atomic_thread_fence(std::memory_order_acquire);
+            if (slot.mSequence.load(std::memory_order_relaxed) == cursor)
+            {
+                ++cursor;
+                return true;
+            }
+        }
+        // The slot was overwritten while reading, resynchronise with the writer
+        cursor = mHeader->mWriteIndex.load(std::memory_order_acquire) - capacity + 1;
+    }
+}
+
+bool IMUShmRing::wait(const uint64_t cursor, const ulong timeoutMs) const
+{
+    struct timespec deadline;
+    clock_gettime(CLOCK_MONOTONIC, &deadline);
+    deadline.tv_sec += timeoutMs / 1000;
+    deadline.tv_nsec += (timeoutMs % 1000) * 1000000L;
+    if (deadline.tv_nsec >= NSEC_PER_SEC)
+    {
+        deadline.tv_sec += 1;
+        deadline.tv_nsec -= NSEC_PER_SEC;
+    }
+
+    while (mHeader->mWriteIndex.load(std::memory_order_acquire) <= cursor)
+    {
+        mHeader->mWaiters.fetch_add(1, std::memory_order_seq_cst);
+        const uint32_t futexValue = mHeader->mFutex.load(std::memory_order_seq_cst);
+        long retVal = 0;
+        if (mHeader->mWriteIndex.load(std::memory_order_acquire) <= cursor)
+        {
+            retVal = futexWait(mHeader->mFutex, futexValue, deadline);
+        }
+        mHeader->mWaiters.fetch_sub(1, std::memory_order_seq_cst);
+
+        if (retVal < 0 && errno == ETIMEDOUT)
+        {
+            return mHeader->mWriteIndex.load(std::memory_order_acquire) > cursor;
+        }
+    }
+    return true;
+}
+
+uint64_t IMUShmRing::getWriteIndex() const
+{
+    return mHeader->mWriteIndex.load(std::memory_order_acquire);
+}
+
+bool IMUShmRing::format(const int fd, const uint32_t capacity)
+{
+    const size_t size = segmentSize(capacity);
+    if (ftruncate(fd, size) < 0)
+    {
+        spdlog::error("Failed to size shared memory segment {}: {}", mName, strerror(errno));
+        return false;
+    }
+    if (!map(fd, size))
+    {
+        return false;
+    }
+
+    // Slots are initialised before the header is published so readers never see a half-built ring
+    for (uint32_t i = 0; i < capacity; ++i)
+    {
+        new (&mSlots[i].mSequence) std::atomic<uint64_t>(SLOT_BUSY);
+    }
+    new (&mHeader->mWriteIndex) std::atomic<uint64_t>(0);
+    new (&mHeader->mFutex) std::atomic<uint32_t>(0);
+    new (&mHeader->mWaiters) std::atomic<uint32_t>(0);
+    mHeader->mCapacity = capacity;
+    std::atomic_thread_fence(std::memory_order_release);
+    mHeader->mMagic = RING_MAGIC;
+    return true;
+}
+
+bool IMUShmRing::attach(const int fd)
+{
+    struct stat st;
+    if (fstat(fd, &st) < 0 || static_cast<size_t>(st.st_size) < sizeof(Header))
+    {
+        spdlog::error("Shared memory segment {} is too small", mName);
+        return false;
+    }
+    if (!map(fd, st.st_size))
+    {
+        return false;
+    }
+    if (mHeader->mMagic != RING_MAGIC || segmentSize(mHeader->mCapacity) > mSize)
+    {
+        spdlog::error("Shared memory segment {} has an invalid layout", mName);
+        return false;
+    }
+    return true;
+}
+
+bool IMUShmRing::map(const int fd, const size_t size)
+{
+    void* addr = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    if (addr == MAP_FAILED)
+    {
+        spdlog::error("Failed to map shared memory segment {}: {}", mName, strerror(errno));
+        return false;
+    }
+    mSize = size;
+    mHeader = static_cast<Header*>(addr);
+    mSlots = reinterpret_cast<Slot*>(mHeader + 1);
+    return true;
+}
+
+size_t IMUShmRing::segmentSize(const uint32_t capacity)
+{
+    return sizeof(Header) + static_cast<size_t>(capacity) * sizeof(Slot);
+}
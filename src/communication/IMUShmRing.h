@@ -0,0 +1,197 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <string>
+
+#include "core/PayloadIMU.h"
+
+/**
+ * @brief Single-producer/multi-consumer ring of IMU samples in POSIX shared memory
+ *
+ * The publisher creates the segment and writes every sample exactly once. Each
+ * subscriber maps the same segment and reads with its own cursor, so adding
+ * consumers costs nothing on the publishing side. Slots are protected with a
+ * per-slot sequence number (seqlock), which lets readers detect that they were
+ * lapped by the writer. Readers sleep on a futex that the writer only wakes when
+ * somebody is actually waiting. The segment is either a named POSIX shared
+ * memory object or a sealed memfd passed to subscribers as a descriptor.
+ */
+class IMUShmRing
+{
+public:
+    /**
+     * @brief Constructor initializes an unmapped ring
+     */
+    IMUShmRing();
+
+    /**
+     * @brief Destructor unmaps the segment and unlinks it if this instance created it
+     */
+    ~IMUShmRing();
+
+    IMUShmRing(const IMUShmRing&) = delete;
+    IMUShmRing& operator=(const IMUShmRing&) = delete;
+
+    /**
+     * @brief Create and map a new shared memory segment (publisher side)
+     *
+     * @param name The POSIX shared memory name, must start with '/'
+     * @param capacity Number of sample slots in the ring
+     * @return true if the segment was created and mapped
+     */
+    bool create(const std::string& name, const uint32_t capacity);
+
+    /**
+     * @brief Create and map a ring in a sealed memfd (publisher side)
+     *
+     * The segment has no name in the file system, subscribers get it through
+     * getFd() passed over SCM_RIGHTS. Its size is sealed so that nobody can
+     * shrink it under the other mappings.
+     *
+     * @param name Name of the memfd, for debugging only
+     * @param capacity Number of sample slots in the ring
+     * @return true if the memfd was created, sealed and mapped
+     */
+    bool createMemfd(const std::string& name, const uint32_t capacity);
+
+    /**
+     * @brief Map an existing shared memory segment (subscriber side)
+     *
+     * @param name The POSIX shared memory name handed out by the publisher
+     * @return true if the segment was opened, validated and mapped
+     */
+    bool open(const std::string& name);
+
+    /**
+     * @brief Map a ring received as a file descriptor (subscriber side)
+     *
+     * @param fd Descriptor of a sealed memfd ring, always closed by this call
+     * @return true if the descriptor was validated and mapped
+     */
+    bool open(const int fd);
+
+    /**
+     * @brief Unmap the segment, close the memfd and unlink the segment if this instance created it
+     */
+    void close();
+
+    /**
+     * @brief Append a sample to the ring and wake up waiting readers
+     *
+     * @param data The IMU sample to publish
+     */
+    void write(const Payload_IMU_t& data);
+
+    /**
+     * @brief Read the sample at the given cursor
+     *
+     * If the writer has lapped the reader, the cursor is moved forward to the
+     * oldest sample that is still available.
+     *
+     * @param cursor Sequence number of the next sample to read, advanced on success
+     * @param data Output sample
+     * @return true if a sample was read, false if no new sample is available
+     */
+    bool read(uint64_t& cursor, Payload_IMU_t& data) const;
+
+    /**
+     * @brief Block until a sample newer than the cursor is available
+     *
+     * @param cursor Sequence number of the next sample to read
+     * @param timeoutMs Maximum time to wait in milliseconds
+     * @return true if data is available, false on timeout
+     */
+    bool wait(const uint64_t cursor, const ulong timeoutMs) const;
+
+    /**
+     * @brief Get the sequence number of the next sample to be written
+     *
+     * @return The write index
+     */
+    uint64_t getWriteIndex() const;
+
+    /**
+     * @brief Check if the ring is mapped
+     *
+     * @return true if a segment is mapped
+     */
+    inline bool isOpen() const { return mHeader != nullptr; }
+
+    /**
+     * @brief Get the name of the mapped segment
+     *
+     * @return The POSIX shared memory name
+     */
+    inline const std::string& getName() const { return mName; }
+
+    /**
+     * @brief Get the descriptor of a memfd ring created by this instance
+     *
+     * @return The memfd, or -1 for named segments
+     */
+    inline int getFd() const { return mFd; }
+
+private:
+    /**
+     * @brief Segment header shared by the writer and all readers
+     */
+    struct alignas(64) Header
+    {
+        uint32_t mMagic;                    ///< Layout identifier
+        uint32_t mCapacity;                 ///< Number of slots
+        std::atomic<uint64_t> mWriteIndex;  ///< Sequence number of the next sample to write
+        std::atomic<uint32_t> mFutex;       ///< Futex word bumped on every write
+        std::atomic<uint32_t> mWaiters;     ///< Number of readers sleeping on the futex
+    };
+
+    /**
+     * @brief A single sample slot guarded by its sequence number
+     */
+    struct Slot
+    {
+        std::atomic<uint64_t> mSequence;    ///< Sequence number of the stored sample
+        Payload_IMU_t mData;                ///< The stored sample
+    };
+
+    /**
+     * @brief Size, map and initialise a new segment
+     *
+     * @param fd File descriptor of the segment
+     * @param capacity Number of slots
+     * @return true if the ring is ready to be written
+     */
+    bool format(const int fd, const uint32_t capacity);
+
+    /**
+     * @brief Map and validate an existing segment
+     *
+     * @param fd File descriptor of the segment
+     * @return true if the segment holds a valid ring
+     */
+    bool attach(const int fd);
+
+    /**
+     * @brief Map the file descriptor of an opened segment
+     *
+     * @param fd File descriptor of the segment
+     * @param size Size of the segment in bytes
+     * @return true if mapping succeeded
+     */
+    bool map(const int fd, const size_t size);
+
+    /**
+     * @brief Compute the size of a segment for a given capacity
+     *
+     * @param capacity Number of slots
+     * @return Segment size in bytes
+     */
+    static size_t segmentSize(const uint32_t capacity);
+
+    std::string mName;   ///< POSIX shared memory name
+    bool mOwner;         ///< true if this instance created (and must unlink) the segment
+    int mFd;             ///< memfd kept open to be handed to subscribers, -1 otherwise
+    size_t mSize;        ///< Mapped size in bytes
+    Header* mHeader;     ///< Pointer to the mapped header
+    Slot* mSlots;        ///< Pointer to the first slot
+};
@@ -1,3 +1,5 @@
+#include <arpa/inet.h>
+#include <netinet/in.h>
 #include <spdlog/spdlog.h>
 #include <sys/mman.h>
 #include <sys/socket.h>
@@ -8,6 +10,7 @@
 IMUSocketHandler::IMUSocketHandler(const bool realTime) 
 : mSocket(-1),
   mParameters(),
+  mUring(),
   mThread(0),
   mRun(false)
 {
@@ -51,8 +54,13 @@ bool IMUSocketHandler::startThread(const int priority, const int policy)
         }
     }
     
+    // The flag has to be raised before the thread starts, otherwise its loop may exit straight away
+    mRun.store(true, std::memory_order_release);
     bool retVal = (0 == pthread_create(&mThread, &attr, IMUSocketHandler::startThread, this));
-    mRun.store(retVal, std::memory_order_release);
+    if (!retVal)
+    {
+        mRun.store(false, std::memory_order_release);
+    }
     
     pthread_attr_destroy(&attr);
     return retVal;
@@ -73,6 +81,16 @@ void IMUSocketHandler::stopThread()
     }
 }
 
+void IMUSocketHandler::setupIoBackend(const unsigned entries)
+{
+    mUring.close();
+    if (mParameters.mIoBackend == IoBackend::URING && !mUring.setup(entries))
+    {
+        spdlog::warn("Falling back to socket calls");
+        mParameters.mIoBackend = IoBackend::SOCKET_CALLS;
+    }
+}
+
 void IMUSocketHandler::disconnect()
 {
     if (mSocket >= 0)
@@ -85,12 +103,18 @@ void IMUSocketHandler::disconnect()
 
 bool IMUSocketHandler::setupSocket(const std::string& socketToBind)
 {
-    spdlog::info("Creating socket at path: {}", mParameters.mSocketPath);
-    mSocket = socket(AF_UNIX, SOCK_DGRAM, 0);
-    if (mSocket < 0)
+    mSocket = bindSocket(socketToBind);
+    return mSocket >= 0;
+}
+
+int IMUSocketHandler::bindSocket(const std::string& socketToBind)
+{
+    spdlog::info("Creating socket at path: {}", socketToBind);
+    int fd = socket(AF_UNIX, SOCK_DGRAM, 0);
+    if (fd < 0)
     {
         spdlog::error("Failed to create the socket. Error code: {}", strerror(errno));
-        return false;
+        return -1;
     }
 
     struct sockaddr_un addr;
@@ -99,14 +123,83 @@ bool IMUSocketHandler::setupSocket(const std::string& socketToBind)
     strncpy(addr.sun_path, socketToBind.c_str(), sizeof(addr.sun_path) - 1);
     
     // Bind to the address
-    if (bind(mSocket, reinterpret_cast<struct sockaddr*>(&addr), sizeof(addr)) < 0)
+    if (bind(fd, reinterpret_cast<struct sockaddr*>(&addr), sizeof(addr)) < 0)
     {
         spdlog::error("Failed to bind a socket: {0}, error message: {1}", socketToBind, strerror(errno));
-        return false;
+        close(fd);
+        return -1;
     }
 
     spdlog::info("Socket created successfully.");
-    return true;
+    return fd;
+}
+
+int IMUSocketHandler::setupMulticastSocket(const Parameters& params, const bool sender)
+{
+    struct sockaddr_in group;
+    memset(&group, 0, sizeof(group));
+    group.sin_family = AF_INET;
+    group.sin_port = htons(params.mMulticastPort);
+    struct in_addr interface;
+    interface.s_addr = htonl(INADDR_ANY);
+    if (inet_pton(AF_INET, params.mMulticastGroup.c_str(), &group.sin_addr) != 1 || !IN_MULTICAST(ntohl(group.sin_addr.s_addr)))
+    {
+        spdlog::error("Invalid multicast group: {}", params.mMulticastGroup);
+        return -1;
+    }
+    if (!params.mMulticastInterface.empty() && inet_pton(AF_INET, params.mMulticastInterface.c_str(), &interface) != 1)
+    {
+        spdlog::error("Invalid multicast interface address: {}", params.mMulticastInterface);
+        return -1;
+    }
+
+    spdlog::info("Creating multicast socket for group {}:{}", params.mMulticastGroup, params.mMulticastPort);
+    int fd = socket(AF_INET, SOCK_DGRAM | SOCK_CLOEXEC, 0);
+    if (fd < 0)
+    {
+        spdlog::error("Failed to create the multicast socket: {}", strerror(errno));
+        return -1;
+    }
+
+    bool retVal = true;
+    const int enable = 1;
+    if (sender)
+    {
+        // Local subscribers receive the group through the loopback copy
+        const unsigned char ttl = static_cast<unsigned char>(params.mMulticastTtl);
+        const unsigned char loop = 1;
+        retVal = setsockopt(fd, IPPROTO_IP, IP_MULTICAST_TTL, &ttl, sizeof(ttl)) == 0 &&
+                 setsockopt(fd, IPPROTO_IP, IP_MULTICAST_LOOP, &loop, sizeof(loop)) == 0 &&
+                 setsockopt(fd, IPPROTO_IP, IP_MULTICAST_IF, &interface, sizeof(interface)) == 0 &&
+                 (params.mSocketBufferBytes == 0 ||
+                  setsockopt(fd, SOL_SOCKET, SO_SNDBUF, &params.mSocketBufferBytes, sizeof(int)) == 0) &&
+                 connect(fd, reinterpret_cast<struct sockaddr*>(&group), sizeof(group)) == 0;
+    }
+    else
+    {
+        // Binding to the group address filters out other groups sharing the port. Either reuse option
+        // alone lets other local receivers bind it, so both are left to --reuse-port
+        struct ip_mreq membership;
+        membership.imr_multiaddr = group.sin_addr;
+        membership.imr_interface = interface;
+        retVal = (!params.mReusePort ||
+                  (setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &enable, sizeof(enable)) == 0 &&
+                   setsockopt(fd, SOL_SOCKET, SO_REUSEPORT, &enable, sizeof(enable)) == 0)) &&
+                 (params.mSocketBufferBytes == 0 ||
+                  setsockopt(fd, SOL_SOCKET, SO_RCVBUF, &params.mSocketBufferBytes, sizeof(int)) == 0) &&
+                 bind(fd, reinterpret_cast<struct sockaddr*>(&group), sizeof(group)) == 0 &&
+                 setsockopt(fd, IPPROTO_IP, IP_ADD_MEMBERSHIP, &membership, sizeof(membership)) == 0;
+    }
+
+    if (!retVal)
+    {
+        spdlog::error("Failed to configure the multicast socket: {}", strerror(errno));
+        close(fd);
+        return -1;
+    }
+
+    spdlog::info("Multicast socket created successfully.");
+    return fd;
 }
 
 void* IMUSocketHandler::startThread(void* instance)
@@ -4,6 +4,7 @@
 #include <pthread.h>
 
 #include "core/Parameters.h"
+#include "IOUring.h"
 
 /**
  * @brief Base class for IMU socket communication handling
@@ -85,8 +86,41 @@ protected:
      */
     virtual bool setupSocket(const std::string& socketToBind);
 
+    /**
+     * @brief Create a Unix domain datagram socket bound to a path
+     * 
+     * @param socketToBind The path to bind the socket to
+     * @return The socket file descriptor, or -1 on failure
+     */
+    static int bindSocket(const std::string& socketToBind);
+
+    /**
+     * @brief Create the UDP socket of the multicast transport
+     * 
+     * A sender is connected to the group with the configured TTL, interface
+     * and send buffer. A receiver is bound to the group port, joins the group
+     * on the configured interface and gets the configured receive buffer. It
+     * shares the port with other local receivers only with --reuse-port.
+     * 
+     * @param params The parameters holding the multicast settings
+     * @param sender true for the publishing side, false for a subscriber
+     * @return The socket file descriptor, or -1 on failure
+     */
+    static int setupMulticastSocket(const Parameters& params, const bool sender);
+
+    /**
+     * @brief Set up io_uring if --io-backend uring was requested
+     * 
+     * Falls back to the socket calls, and records it in the parameters, when
+     * the kernel does not offer io_uring.
+     * 
+     * @param entries Number of submission queue entries
+     */
+    void setupIoBackend(const unsigned entries);
+
     int mSocket;             ///< Socket file descriptor
     Parameters mParameters;  ///< Configuration parameters
+    IOUring mUring;          ///< io_uring instance, open only with IoBackend::URING
 
 private:
     /**
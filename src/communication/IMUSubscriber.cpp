@@ -1,14 +1,77 @@
+#include <algorithm>
 #include <csignal>
 #include <filesystem>
 #include <iostream>
 #include <iomanip>
+#include <poll.h>
+#include <sys/inotify.h>
 #include <sys/socket.h>
 #include <sys/un.h>
 
 #include "communication/IMUSubscriber.h"
-#include "core/PayloadIMU.h"
+#include "core/FrameIMU.h"
+#include "core/Protocol.h"
 
-inline constexpr char REG_MSG[9] = "REGISTER";
+namespace
+{
+/** Wait slice used by the shared memory transport when no timeout is configured */
+inline constexpr ulong SHM_WAIT_SLICE_MS = 100;
+/** Longest sleep between two checks for a stop request while backing off */
+inline constexpr ulong RECONNECT_SLICE_MS = 100;
+inline constexpr long NSEC_PER_SEC = 1000000000L;
+inline constexpr long NSEC_PER_MSEC = 1000000L;
+inline constexpr unsigned URING_RECV_ENTRIES = 8;
+/** Provided buffers of the multishot receive, a power of two */
+inline constexpr uint16_t URING_RECV_BUFFERS = 64;
+inline constexpr uint16_t URING_BUFFER_GROUP = 0;
+/** Each buffer holds the receive header followed by a whole frame, rounded up to keep the frames aligned */
+inline constexpr size_t URING_BUFFER_SIZE = (sizeof(struct io_uring_recvmsg_out) + sizeof(Frame_IMU_t) + 63) & ~size_t(63);
+
+/**
+ * @brief Get the current CLOCK_MONOTONIC time in nanoseconds
+ */
+inline uint64_t monotonicNs()
+{
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return static_cast<uint64_t>(now.tv_sec) * NSEC_PER_SEC + now.tv_nsec;
+}
+
+/**
+ * @brief Get the time elapsed since a timestamp, clamped at zero
+ */
+inline uint64_t elapsedNs(const uint64_t nowNs, const uint64_t thenNs)
+{
+    return nowNs > thenNs ? nowNs - thenNs : 0;
+}
+
+/**
+ * @brief Watch the directories of the registration sockets for files being created
+ *
+ * A publisher that comes back binds its socket there, which ends the
+ * reconnection backoff at once.
+ *
+ * @return A non-blocking inotify descriptor, -1 if it could not be created
+ */
+int watchRegistrationPaths(const std::vector<std::string>& paths)
+{
+    const int watch = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+    if (watch < 0)
+    {
+        spdlog::warn("Failed to watch for publishers, reconnecting on backoff only: {}", strerror(errno));
+        return -1;
+    }
+    for (const std::string& path : paths)
+    {
+        const std::string directory = std::filesystem::path(path).parent_path().string();
+        if (inotify_add_watch(watch, directory.empty() ? "." : directory.c_str(), IN_CREATE | IN_MOVED_TO) < 0)
+        {
+            spdlog::warn("Failed to watch {} for publishers: {}", directory, strerror(errno));
+        }
+    }
+    return watch;
+}
+} // end of anonymous namespace
 
 namespace
 {
@@ -52,6 +115,18 @@ IMUSubscriber::IMUSubscriber()
 : IMUSocketHandler()
 , mClientSocketPath("")
 , mAhrs(std::nullopt)
+, mRing()
+, mFrames()
+, mIovecs()
+, mMessages()
+, mUringHeader()
+, mReceiveStats()
+, mSequenceTracker()
+, mTransportLatency()
+, mEndToEndLatency()
+, mRecorder()
+, mNextStatsNs(0)
+, mGroupSilent(false)
 {
 }
 
@@ -65,62 +140,394 @@ bool IMUSubscriber::initialise(const Parameters& params)
     IMUSocketHandler::initialise(params);
     mClientSocketPath = params.mSocketPath + "_client" + std::to_string(getpid());
     
-    // Create AHRS instance based on parameters
-    mAhrs = VariantAHRS::create(params.mAhrsType, params.mFrequencyHz);
+    // Create AHRS instance based on parameters, at the rate the publisher actually delivers
+    float ahrsRateHz = static_cast<float>(params.mFrequencyHz);
+    if (params.mTransport == TransportType::SOCKET)
+    {
+        ahrsRateHz /= rateDivider(params.mFrequencyHz, params.mOutputRateHz);
+    }
+    mAhrs = VariantAHRS::create(params.mAhrsType, ahrsRateHz, params.mIgnoreMagnetometer, params.mAhrsPrecision);
+    
+    // Preallocate the bulk receive array
+    mFrames.resize(params.mRecvBatch);
+    mIovecs.resize(params.mRecvBatch);
+    mMessages.resize(params.mRecvBatch);
+    for (int i = 0; i < params.mRecvBatch; ++i)
+    {
+        mIovecs[i].iov_base = &mFrames[i];
+        mIovecs[i].iov_len = sizeof(Frame_IMU_t);
+        memset(&mMessages[i], 0, sizeof(struct mmsghdr));
+        mMessages[i].msg_hdr.msg_iov = &mIovecs[i];
+        mMessages[i].msg_hdr.msg_iovlen = 1;
+    }
+    mReceiveStats = ReceiveStats();
+    mSequenceTracker.reset();
+    mTransportLatency.reset();
+    mEndToEndLatency.reset();
+    if (!params.mRecordFile.empty() && !mRecorder.open(params.mRecordFile))
+    {
+        return false;
+    }
+
+    // A reduced-rate stream must not trip the receive timeout between two samples
+    if (params.mOutputRateHz > 0 && params.mTimeoutMs > 0 &&
+        params.mTimeoutMs * params.mOutputRateHz < 2000)
+    {
+        spdlog::warn("Timeout of {} ms is short for an output rate of {} Hz", params.mTimeoutMs, params.mOutputRateHz);
+    }
+
+    // A lost publisher is only noticed through the receive timeout
+    if (params.mReconnect && params.mTimeoutMs == 0)
+    {
+        spdlog::warn("Reconnection needs --timeout-ms, a lost publisher cannot be detected without it");
+    }
+    if (!params.mReconnect && !params.mStandbySocketPaths.empty())
+    {
+        spdlog::warn("Standby socket paths are only used with --reconnect");
+    }
+    mGroupSilent = false;
     
     disconnect();
-    return setupSocket(mClientSocketPath) && registerToServer() && setSocketTimeout();
+    if (params.mTransport == TransportType::UDP)
+    {
+        // Joining the multicast group replaces the registration with the publisher
+        mSocket = setupMulticastSocket(params, false);
+        if (mSocket < 0 || !setSocketTimeout())
+        {
+            return false;
+        }
+    }
+    else if (!setupSocket(mClientSocketPath) || !setSocketTimeout() || !registerToServer())
+    {
+        return false;
+    }
+
+    // The ring transports read shared memory, only the socket transports receive through io_uring
+    if (!isRingTransport(params.mTransport))
+    {
+        setupUringReceive();
+    }
+    return true;
 }
 
 void IMUSubscriber::threadBody()
 {
-    Payload_IMU_t imuData;
-    ssize_t bytes_read;
-    struct sockaddr_un src_addr;
-    socklen_t addrlen = sizeof(src_addr);
+    if (isRingTransport(mParameters.mTransport))
+    {
+        receiveFromRing();
+    }
+    else if (mUring.isOpen())
+    {
+        receiveWithUring();
+    }
+    else
+    {
+        receiveFromSocket();
+    }
+}
+
+void IMUSubscriber::receiveFromSocket()
+{
+    int received;
+    const Payload_IMU_t* latest;
     
     while (isRunning())
     {
-        bytes_read = recvfrom(mSocket, &imuData, sizeof(Payload_IMU_t), 0,
-                            reinterpret_cast<struct sockaddr*>(&src_addr), &addrlen);
+        // Block for the first datagram, then drain whatever else is already queued
+        received = recvmmsg(mSocket, mMessages.data(), mMessages.size(), MSG_WAITFORONE, nullptr);
+        const uint64_t receiveNs = monotonicNs();
         
-        if (bytes_read < 0)
+        if (received < 0)
         {
-            if (errno == EAGAIN || errno == EWOULDBLOCK)
+            if ((errno == EAGAIN || errno == EWOULDBLOCK) && !handlePublisherTimeout())
             {
-                // Timeout occurred. Log error and raise SIGALRM
-                spdlog::error("Timeout, the publisher might be down. Exiting...");
-                raise(SIGALRM);
+                break;
             }
             else
             {
                 spdlog::error("Error reading from socket: {}", strerror(errno));
             }
         }
-        else if (bytes_read == 0)
+        else if (received == 0)
         {
             spdlog::warn("No data was read!");
         }
-        else if (bytes_read != sizeof(Payload_IMU_t))
+        else
         {
-            spdlog::warn("Incomplete data received: {} bytes", bytes_read);
+            latest = nullptr;
+            for (int i = 0; i < received; ++i)
+            {
+                const Frame_IMU_t& frame = mFrames[i];
+                if (mMessages[i].msg_len == 0)
+                {
+                    spdlog::warn("No data was read!");
+                }
+                else if (isValidFrame(frame, mMessages[i].msg_len))
+                {
+                    processData(frame.samples, frame.header.sampleCount, frame.header.sequence, receiveNs);
+                    latest = &frame.samples[frame.header.sampleCount - 1];
+                }
+            }
+            updateReceiveStats(received);
+
+            if (latest != nullptr)
+            {
+                // Print the latest sample together with the resulting orientation
+                printIMUData(*latest, mAhrs);
+            }
         }
-        else
+    }
+    logReceiveStats();
+}
+
+void IMUSubscriber::receiveWithUring()
+{
+    // The publisher is declared silent on a monotonic deadline, wakeups for error completions do not count
+    const uint64_t timeoutNs = static_cast<uint64_t>(mParameters.mTimeoutMs) * NSEC_PER_MSEC;
+    uint64_t lastDataNs = monotonicNs();
+    struct timespec timeout;
+    const struct timespec* waitTimeout = mParameters.mTimeoutMs > 0 ? &timeout : nullptr;
+    bool armed = false;
+    bool supported = false;
+    Payload_IMU_t latest;
+
+    while (isRunning())
+    {
+        if (!armed)
         {
-            if (mAhrs)
+            armed = armReceive();
+        }
+
+        // Submit the receive if it has to be re-armed and wait for the first completion, at most until the deadline
+        if (waitTimeout != nullptr)
+        {
+            const uint64_t remainingNs = timeoutNs - std::min(timeoutNs, elapsedNs(monotonicNs(), lastDataNs));
+            timeout.tv_sec = remainingNs / NSEC_PER_SEC;
+            timeout.tv_nsec = remainingNs % NSEC_PER_SEC;
+        }
+        const int retVal = mUring.submit(1, waitTimeout);
+        const uint64_t receiveNs = monotonicNs();
+        if (retVal < 0 && retVal != -ETIME && retVal != -EINTR)
+        {
+            spdlog::error("Error waiting for io_uring completions: {}", strerror(-retVal));
+        }
+
+        size_t drained = 0;
+        bool hasLatest = false;
+        for (struct io_uring_cqe* cqe = mUring.peekCqe(); cqe != nullptr; cqe = mUring.peekCqe())
+        {
+            const int result = cqe->res;
+            const uint32_t flags = cqe->flags;
+            mUring.seenCqe();
+
+            // The kernel ends a multishot receive on errors and when it runs out of buffers
+            if ((flags & IORING_CQE_F_MORE) == 0)
             {
-                // Process received data with AHRS
-                mAhrs->update(imuData);
+                armed = false;
             }
-            // Print the data
+            if (result < 0)
+            {
+                if (result == -EINVAL && !supported)
+                {
+                    spdlog::warn("Multishot receives are not supported, falling back to recvmmsg()");
+                    mUring.close();
+                    mParameters.mIoBackend = IoBackend::SOCKET_CALLS;
+                    receiveFromSocket();
+                    return;
+                }
+                if (result != -ENOBUFS)
+                {
+                    spdlog::error("Error reading from socket: {}", strerror(-result));
+                }
+                continue;
+            }
+            supported = true;
+            if ((flags & IORING_CQE_F_BUFFER) == 0)
+            {
+                continue;
+            }
+
+            const uint16_t bufferId = static_cast<uint16_t>(flags >> IORING_CQE_BUFFER_SHIFT);
+            const uint8_t* buffer = mUring.getBuffer(bufferId);
+            const struct io_uring_recvmsg_out* out = reinterpret_cast<const struct io_uring_recvmsg_out*>(buffer);
+            const Frame_IMU_t& frame = *reinterpret_cast<const Frame_IMU_t*>(buffer + sizeof(struct io_uring_recvmsg_out));
+            if (out->payloadlen == 0)
+            {
+                spdlog::warn("No data was read!");
+            }
+            else if ((out->flags & MSG_TRUNC) == 0 && isValidFrame(frame, out->payloadlen))
+            {
+                processData(frame.samples, frame.header.sampleCount, frame.header.sequence, receiveNs);
+                latest = frame.samples[frame.header.sampleCount - 1];
+                hasLatest = true;
+            }
+            mUring.recycleBuffer(bufferId);
+            ++drained;
+        }
+
+        if (drained > 0)
+        {
+            lastDataNs = receiveNs;
+            updateReceiveStats(drained);
+            if (hasLatest)
+            {
+                // Print the latest sample together with the resulting orientation
+                printIMUData(latest, mAhrs);
+            }
+        }
+        else if (waitTimeout != nullptr && elapsedNs(receiveNs, lastDataNs) >= timeoutNs)
+        {
+            // A lone error completion, such as the multishot receive ending on -ENOBUFS, is re-armed above
+            if (!handlePublisherTimeout())
+            {
+                break;
+            }
+            lastDataNs = monotonicNs();
+        }
+    }
+    logReceiveStats();
+}
+
+bool IMUSubscriber::armReceive()
+{
+    struct io_uring_sqe* sqe = mUring.getSqe();
+    if (sqe == nullptr)
+    {
+        return false;
+    }
+    sqe->opcode = IORING_OP_RECVMSG;
+    sqe->fd = mSocket;
+    sqe->addr = reinterpret_cast<uint64_t>(&mUringHeader);
+    sqe->len = 1;
+    sqe->ioprio = IORING_RECV_MULTISHOT;
+    sqe->flags = IOSQE_BUFFER_SELECT;
+    sqe->buf_group = URING_BUFFER_GROUP;
+    return true;
+}
+
+void IMUSubscriber::receiveFromRing()
+{
+    Payload_IMU_t imuData;
+    // Only samples published after the registration are of interest
+    uint64_t cursor = mRing.getWriteIndex();
+    const ulong waitMs = mParameters.mTimeoutMs > 0 ? mParameters.mTimeoutMs : SHM_WAIT_SLICE_MS;
+
+    while (isRunning())
+    {
+        if (mRing.read(cursor, imuData))
+        {
+            // Slots skipped after being lapped by the publisher show up as lost samples
+            processData(&imuData, 1, cursor - 1, monotonicNs());
+            updateReceiveStats(1);
             printIMUData(imuData, mAhrs);
         }
+        else if (!mRing.wait(cursor, waitMs) && mParameters.mTimeoutMs > 0)
+        {
+            if (!handlePublisherTimeout())
+            {
+                break;
+            }
+            // A new ring starts at its own write index
+            cursor = mRing.getWriteIndex();
+        }
+    }
+    logReceiveStats();
+}
+
+bool IMUSubscriber::isValidFrame(const Frame_IMU_t& frame, const size_t bytes) const
+{
+    if (bytes < sizeof(FrameHeader_t))
+    {
+        spdlog::warn("Incomplete data received: {} bytes", bytes);
+        return false;
+    }
+    if (frame.header.version != FRAME_VERSION)
+    {
+        spdlog::warn("Unsupported frame version: {}", frame.header.version);
+        return false;
+    }
+    if (frame.header.sampleCount == 0 || frame.header.sampleCount > MAX_FRAME_SAMPLES ||
+        bytes != frameSize(frame.header.sampleCount))
+    {
+        spdlog::warn("Malformed frame received: {} samples in {} bytes", frame.header.sampleCount, bytes);
+        return false;
+    }
+    return true;
+}
+
+void IMUSubscriber::processData(const Payload_IMU_t* samples, const size_t count, const uint64_t sequence,
+                                const uint64_t receiveNs)
+{
+    for (size_t i = 0; i < count; ++i)
+    {
+        mSequenceTracker.track(sequence + i);
+        mTransportLatency.record(elapsedNs(receiveNs, samples[i].publishNs));
+    }
+    if (mAhrs)
+    {
+        // Process received data with AHRS, in publishing order
+        mAhrs->update(samples, count);
+    }
+
+    // The whole batch is processed at once, a single clock read serves all its samples
+    const uint64_t processedNs = monotonicNs();
+    for (size_t i = 0; i < count; ++i)
+    {
+        mEndToEndLatency.record(elapsedNs(processedNs, samples[i].acquisitionNs));
+    }
+    mRecorder.write(samples, count);
+    mReceiveStats.mSamples += count;
+    mGroupSilent = false;
+}
+
+void IMUSubscriber::updateReceiveStats(const size_t drained)
+{
+    ++mReceiveStats.mWakeups;
+    mReceiveStats.mDatagrams += drained;
+    mReceiveStats.mMaxDrained = std::max<uint64_t>(mReceiveStats.mMaxDrained, drained);
+
+    if (mParameters.mStatsPeriodMs > 0)
+    {
+        struct timespec now;
+        clock_gettime(CLOCK_MONOTONIC, &now);
+        const long nowNs = now.tv_sec * NSEC_PER_SEC + now.tv_nsec;
+        if (nowNs >= mNextStatsNs)
+        {
+            if (mNextStatsNs > 0)
+            {
+                logReceiveStats();
+            }
+            mNextStatsNs = nowNs + static_cast<long>(mParameters.mStatsPeriodMs) * NSEC_PER_MSEC;
+        }
     }
 }
 
+void IMUSubscriber::logReceiveStats() const
+{
+    const double perWakeup = mReceiveStats.mWakeups > 0
+        ? static_cast<double>(mReceiveStats.mDatagrams) / mReceiveStats.mWakeups : 0.0;
+    spdlog::info("Receive stats: batch size {}, {} wakeups, {} datagrams, {} samples, "
+                 "{:.2f} datagrams per wakeup (max {}), {} reconnections",
+                 mMessages.size(), mReceiveStats.mWakeups, mReceiveStats.mDatagrams,
+                 mReceiveStats.mSamples, perWakeup, mReceiveStats.mMaxDrained, mReceiveStats.mReconnects);
+    spdlog::info("Sequence stats: {} received, {} lost ({:.3f}%), {} duplicated, {} reordered",
+                 mSequenceTracker.getReceived(), mSequenceTracker.getLost(), mSequenceTracker.getLossRate(),
+                 mSequenceTracker.getDuplicates(), mSequenceTracker.getReordered());
+    logLatency("Transport latency (publish to receive)", mTransportLatency);
+    logLatency("End-to-end latency (acquisition to processed)", mEndToEndLatency);
+}
+
+void IMUSubscriber::logLatency(const char* name, const LatencyHistogram& histogram)
+{
+    spdlog::info("{}: {} samples, p50 {:.1f} us, p99 {:.1f} us, p99.9 {:.1f} us, max {:.1f} us",
+                 name, histogram.getCount(), histogram.getPercentile(50.0) / 1e3,
+                 histogram.getPercentile(99.0) / 1e3, histogram.getPercentile(99.9) / 1e3, histogram.getMax() / 1e3);
+}
+
 void IMUSubscriber::disconnect()
 {
     IMUSocketHandler::disconnect();
+    mRing.close();
     
     if (!mClientSocketPath.empty() && std::filesystem::exists(mClientSocketPath))
     {
@@ -130,23 +537,212 @@ void IMUSubscriber::disconnect()
 }
 
 bool IMUSubscriber::registerToServer()
+{
+    const std::string& registrationPath = mParameters.mControlSocketPath.empty() ? mParameters.mSocketPath
+                                                                                 : mParameters.mControlSocketPath;
+    if (!sendRegistration(registrationPath))
+    {
+        spdlog::error("Failed to send registration message: {}", strerror(errno));
+        return false;
+    }
+    
+    spdlog::info("Socket created successfully and registered with publisher");
+    return !isRingTransport(mParameters.mTransport) || attachToRing();
+}
+
+bool IMUSubscriber::sendRegistration(const std::string& registrationPath)
 {   
     // Set up server address
     struct sockaddr_un server_addr;
     memset(&server_addr, 0, sizeof(server_addr));
     server_addr.sun_family = AF_UNIX;
-    strncpy(server_addr.sun_path, mParameters.mSocketPath.c_str(), sizeof(server_addr.sun_path) - 1);
+    strncpy(server_addr.sun_path, registrationPath.c_str(), sizeof(server_addr.sun_path) - 1);
     
+    // Ask for a reduced rate if the full publishing rate is not needed
+    std::string message = REG_MSG;
+    if (mParameters.mOutputRateHz > 0)
+    {
+        message += std::string(" ") + REG_RATE_FIELD + std::to_string(mParameters.mOutputRateHz) + " " + REG_MODE_FIELD +
+                   (mParameters.mRateMode == RateMode::AVERAGE ? "average" : "decimate");
+    }
+
     // Send registration message to publisher
-    if (sendto(mSocket, REG_MSG, strlen(REG_MSG), 0, 
-               reinterpret_cast<struct sockaddr*>(&server_addr), sizeof(server_addr)) < 0)
+    return sendto(mSocket, message.c_str(), message.size(), 0, 
+                  reinterpret_cast<struct sockaddr*>(&server_addr), sizeof(server_addr)) >= 0;
+}
+
+bool IMUSubscriber::handlePublisherTimeout()
+{
+    if (!mParameters.mReconnect)
     {
-        spdlog::error("Failed to send registration message: {}", strerror(errno));
+        // Timeout occurred. Log error and raise SIGALRM
+        spdlog::error("Timeout, the publisher might be down. Exiting...");
+        raise(SIGALRM);
         return false;
     }
-    
-    spdlog::info("Socket created successfully and registered with publisher");
-    return true;
+
+    if (mParameters.mTransport == TransportType::UDP)
+    {
+        // Nothing to register with, the group delivers again as soon as a publisher sends to it
+        if (!mGroupSilent)
+        {
+            spdlog::warn("Timeout, no data from the multicast group. Waiting for the publisher...");
+            mGroupSilent = true;
+        }
+        mSequenceTracker.restart();
+        return isRunning();
+    }
+    return reconnect();
+}
+
+bool IMUSubscriber::reconnect()
+{
+    spdlog::warn("Timeout, the publisher might be down. Reconnecting...");
+    mRing.close();
+
+    std::vector<std::string> candidates;
+    candidates.push_back(mParameters.mControlSocketPath.empty() ? mParameters.mSocketPath
+                                                                : mParameters.mControlSocketPath);
+    candidates.insert(candidates.end(), mParameters.mStandbySocketPaths.begin(), mParameters.mStandbySocketPaths.end());
+
+    const int watch = watchRegistrationPaths(candidates);
+    ulong backoffMs = mParameters.mReconnectBackoffMs;
+    uint64_t attempts = 0;
+    while (isRunning())
+    {
+        for (const std::string& path : candidates)
+        {
+            // A missing or orphaned socket fails right away, so only live publishers are tried further
+            ++attempts;
+            if (!sendRegistration(path))
+            {
+                spdlog::debug("Publisher at {} is not reachable: {}", path, strerror(errno));
+                continue;
+            }
+            if (isRingTransport(mParameters.mTransport) && !attachToRing())
+            {
+                continue;
+            }
+
+            // The AHRS state is kept, only the sequence numbers of the new publisher start over
+            mSequenceTracker.restart();
+            ++mReceiveStats.mReconnects;
+            spdlog::info("Reconnected to publisher at {} after {} attempts", path, attempts);
+            if (watch >= 0)
+            {
+                close(watch);
+            }
+            return true;
+        }
+
+        // Sleep in slices so that a stop request is not held up by a long backoff,
+        // a file created next to a registration socket starts the next round right away
+        bool created = false;
+        for (ulong sleptMs = 0; sleptMs < backoffMs && isRunning() && !created; sleptMs += RECONNECT_SLICE_MS)
+        {
+            const ulong sliceMs = std::min(backoffMs - sleptMs, RECONNECT_SLICE_MS);
+            if (watch < 0)
+            {
+                usleep(sliceMs * 1000);
+                continue;
+            }
+            struct pollfd event = {watch, POLLIN, 0};
+            created = poll(&event, 1, static_cast<int>(sliceMs)) > 0;
+        }
+        if (created)
+        {
+            // Any file may have been created, the backoff goes on if it was not a publisher
+            alignas(struct inotify_event) char events[4096];
+            while (read(watch, events, sizeof(events)) > 0)
+            {
+            }
+            continue;
+        }
+        backoffMs = std::min(backoffMs * 2, mParameters.mReconnectMaxBackoffMs);
+    }
+    if (watch >= 0)
+    {
+        close(watch);
+    }
+    return false;
+}
+
+bool IMUSubscriber::attachToRing()
+{
+    char buffer[CONTROL_MSG_SIZE];
+    struct iovec iov = {buffer, sizeof(buffer) - 1};
+    struct msghdr msg;
+    union
+    {
+        char mBuffer[CMSG_SPACE(sizeof(int))];
+        struct cmsghdr mAlign;
+    } control;
+
+    memset(&msg, 0, sizeof(msg));
+    msg.msg_iov = &iov;
+    msg.msg_iovlen = 1;
+    msg.msg_control = control.mBuffer;
+    msg.msg_controllen = sizeof(control.mBuffer);
+
+    ssize_t bytes_read = recvmsg(mSocket, &msg, MSG_CMSG_CLOEXEC);
+    if (bytes_read < 0)
+    {
+        spdlog::error("No shared memory segment received from publisher: {}", strerror(errno));
+        return false;
+    }
+    buffer[bytes_read] = '\0';
+
+    // Take ownership of a passed descriptor first so that it is never leaked
+    int fd = -1;
+    struct cmsghdr* cmsg = CMSG_FIRSTHDR(&msg);
+    if (cmsg != nullptr && cmsg->cmsg_level == SOL_SOCKET && cmsg->cmsg_type == SCM_RIGHTS &&
+        cmsg->cmsg_len == CMSG_LEN(sizeof(int)))
+    {
+        memcpy(&fd, CMSG_DATA(cmsg), sizeof(int));
+    }
+
+    if (mParameters.mTransport == TransportType::MEMFD && strcmp(buffer, MEMFD_MSG) == 0 && fd >= 0)
+    {
+        return mRing.open(fd);
+    }
+    if (fd >= 0)
+    {
+        close(fd);
+    }
+    if (mParameters.mTransport == TransportType::SHM && strncmp(buffer, SHM_MSG, strlen(SHM_MSG)) == 0)
+    {
+        return mRing.open(std::string(buffer + strlen(SHM_MSG)));
+    }
+
+    spdlog::error("Unexpected registration reply from publisher");
+    return false;
+}
+
+void IMUSubscriber::setupUringReceive()
+{
+    setupIoBackend(URING_RECV_ENTRIES);
+    if (!mUring.isOpen())
+    {
+        return;
+    }
+
+    // A wait that cannot time out would never notice a silent publisher
+    if (mParameters.mTimeoutMs > 0 && !mUring.supportsWaitTimeout())
+    {
+        spdlog::warn("io_uring waits cannot time out on this kernel, falling back to socket calls");
+        mUring.close();
+        mParameters.mIoBackend = IoBackend::SOCKET_CALLS;
+        return;
+    }
+
+    // Sender address and ancillary data are not needed, the buffers only carry the datagrams
+    memset(&mUringHeader, 0, sizeof(mUringHeader));
+    if (!mUring.setupBufferRing(URING_BUFFER_GROUP, URING_RECV_BUFFERS, URING_BUFFER_SIZE))
+    {
+        spdlog::warn("Falling back to socket calls");
+        mUring.close();
+        mParameters.mIoBackend = IoBackend::SOCKET_CALLS;
+    }
 }
 
 bool IMUSubscriber::setSocketTimeout()
@@ -1,8 +1,15 @@
 #pragma once
 
 #include <optional>
+#include <vector>
+#include <sys/socket.h>
 #include "ahrs/VariantAHRS.h"
+#include "core/FrameIMU.h"
+#include "IMUShmRing.h"
 #include "IMUSocketHandler.h"
+#include "SequenceTracker.h"
+#include "utils/LatencyHistogram.h"
+#include "utils/RecordingWriter.h"
 
 /**
  * @brief IMU data subscriber using Unix domain sockets
@@ -14,6 +21,18 @@
 class IMUSubscriber : public IMUSocketHandler
 {
 public:
+    /**
+     * @brief Statistics of the receive path
+     */
+    struct ReceiveStats
+    {
+        uint64_t mWakeups;    ///< Number of receive calls that returned data
+        uint64_t mDatagrams;  ///< Number of datagrams (or ring slots) received
+        uint64_t mSamples;    ///< Number of samples received
+        uint64_t mMaxDrained; ///< Largest number of datagrams drained in a single wakeup
+        uint64_t mReconnects; ///< Number of times the link to a publisher was re-established
+    };
+
     /**
      * @brief Constructor initializes the subscriber
      */
@@ -43,7 +62,107 @@ public:
      */
     void threadBody() override;
 
+    /**
+     * @brief Get the statistics of the receive path
+     * 
+     * @return The receive statistics
+     */
+    inline const ReceiveStats& getReceiveStats() const { return mReceiveStats; }
+
+    /**
+     * @brief Get the loss, duplicate and reorder accounting of received samples
+     * 
+     * @return The sequence tracker
+     */
+    inline const SequenceTracker& getSequenceTracker() const { return mSequenceTracker; }
+
+    /**
+     * @brief Get the publish to receive latency of the received samples
+     * 
+     * @return The transport latency histogram
+     */
+    inline const LatencyHistogram& getTransportLatency() const { return mTransportLatency; }
+
+    /**
+     * @brief Get the acquisition to processed latency of the received samples
+     * 
+     * @return The end-to-end latency histogram
+     */
+    inline const LatencyHistogram& getEndToEndLatency() const { return mEndToEndLatency; }
+
 private:
+    /**
+     * @brief Receive loop for the Unix domain socket transport
+     * 
+     * Each wakeup drains up to --recv-batch queued datagrams with a single
+     * recvmmsg() call and runs all of them through the AHRS before printing.
+     */
+    void receiveFromSocket();
+
+    /**
+     * @brief Receive loop for the socket transports with --io-backend uring
+     * 
+     * A single multishot RECVMSG keeps receiving into provided buffers, so a
+     * wakeup costs one io_uring_enter() no matter how many datagrams it reaps.
+     * Falls back to receiveFromSocket() if the kernel rejects multishot receives.
+     */
+    void receiveWithUring();
+
+    /**
+     * @brief Queue the multishot receive on the data socket
+     * 
+     * @return true if a submission entry was available
+     */
+    bool armReceive();
+
+    /**
+     * @brief Receive loop for the shared memory transport
+     */
+    void receiveFromRing();
+
+    /**
+     * @brief Validate the header of a received frame against its size
+     * 
+     * @param frame The received frame
+     * @param bytes Number of bytes received
+     * @return true if the frame can be processed
+     */
+    bool isValidFrame(const Frame_IMU_t& frame, const size_t bytes) const;
+
+    /**
+     * @brief Account for received samples and run AHRS on them
+     * 
+     * Samples are fed to the AHRS in order. Their transport latency is taken
+     * at receive time and their end-to-end latency once the AHRS is done.
+     * 
+     * @param samples The received IMU samples
+     * @param count Number of samples, at least one
+     * @param sequence Sequence number of the first sample
+     * @param receiveNs CLOCK_MONOTONIC time the samples were received
+     */
+    void processData(const Payload_IMU_t* samples, const size_t count, const uint64_t sequence,
+                     const uint64_t receiveNs);
+
+    /**
+     * @brief Account for a wakeup and log the statistics if the period elapsed
+     * 
+     * @param drained Number of datagrams received in this wakeup
+     */
+    void updateReceiveStats(const size_t drained);
+
+    /**
+     * @brief Log the receive, sequence and latency statistics
+     */
+    void logReceiveStats() const;
+
+    /**
+     * @brief Log the percentiles of a latency histogram
+     * 
+     * @param name Name of the measured latency
+     * @param histogram The latency histogram
+     */
+    static void logLatency(const char* name, const LatencyHistogram& histogram);
+
     /**
      * @brief Registers this subscriber to publisher
      * 
@@ -54,6 +173,51 @@ private:
      */
     bool registerToServer();
 
+    /**
+     * @brief Send the registration message to a publisher
+     * 
+     * @param registrationPath Registration socket of the publisher
+     * @return true if the message was sent, false with errno set otherwise
+     */
+    bool sendRegistration(const std::string& registrationPath);
+
+    /**
+     * @brief React to the publisher going silent for --timeout-ms
+     * 
+     * Without --reconnect, raises SIGALRM to stop the process. With it, the
+     * link is rebuilt by reconnect() while the AHRS state is kept, so the
+     * orientation resumes as soon as a publisher sends again.
+     * 
+     * @return true if the receive loop should carry on
+     */
+    bool handlePublisherTimeout();
+
+    /**
+     * @brief Re-register with the primary publisher or one of the standby ones
+     * 
+     * Every round tries the primary registration socket then each
+     * --standby-socket-path in order, and backs off exponentially between
+     * rounds from --reconnect-backoff-ms up to --reconnect-max-backoff-ms.
+     * The backoff ends early when a file is created in the directory of one
+     * of those sockets, so a publisher binding its socket is registered with
+     * straight away.
+     * 
+     * @return true once registered, false if the subscriber was stopped first
+     */
+    bool reconnect();
+
+    /**
+     * @brief Waits for the publisher to hand out the shared memory segment and maps it
+     * 
+     * @return true if the ring was successfully mapped
+     */
+    bool attachToRing();
+
+    /**
+     * @brief Set up the io_uring instance and its provided buffers if --io-backend uring is requested
+     */
+    void setupUringReceive();
+
     /**
      * @brief Sets the tiemout for the socket.
      * 
@@ -68,4 +232,16 @@ private:
 
     std::string mClientSocketPath; ///< Path to the client socket
     std::optional<VariantAHRS> mAhrs; ///< AHRS processor using variant approach
+    IMUShmRing mRing;                 ///< Shared memory ring used by the SHM transport
+    std::vector<Frame_IMU_t> mFrames; ///< Preallocated frames for bulk receive
+    std::vector<struct iovec> mIovecs; ///< One iovec per preallocated frame
+    std::vector<struct mmsghdr> mMessages; ///< One message per preallocated frame
+    struct msghdr mUringHeader;       ///< Header of the multishot receive, without name or control data
+    ReceiveStats mReceiveStats;       ///< Statistics of the receive path
+    SequenceTracker mSequenceTracker; ///< Loss, duplicate and reorder accounting
+    LatencyHistogram mTransportLatency; ///< Time from publish to receive of every sample
+    LatencyHistogram mEndToEndLatency; ///< Time from acquisition to the end of AHRS processing
+    RecordingWriter mRecorder;        ///< Records every received sample with --record-file
+    long mNextStatsNs;                ///< Monotonic time of the next periodic statistics log
+    bool mGroupSilent;                ///< true while the multicast group stays silent with --reconnect
 };
\ No newline at end of file
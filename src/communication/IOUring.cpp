@@ -0,0 +1,271 @@
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <spdlog/spdlog.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#include "communication/IOUring.h"
+
+namespace
+{
+inline int ioUringSetup(const unsigned entries, struct io_uring_params* params)
+{
+    return static_cast<int>(syscall(__NR_io_uring_setup, entries, params));
+}
+
+inline int ioUringEnter(const int fd, const unsigned toSubmit, const unsigned minComplete, const unsigned flags,
+                        const void* arg, const size_t argSize)
+{
+    return static_cast<int>(syscall(__NR_io_uring_enter, fd, toSubmit, minComplete, flags, arg, argSize));
+}
+
+inline int ioUringRegister(const int fd, const unsigned opcode, const void* arg, const unsigned count)
+{
+    return static_cast<int>(syscall(__NR_io_uring_register, fd, opcode, arg, count));
+}
+
+/**
+ * @brief Map a region of the io_uring instance, nullptr on failure
+ */
+void* mapRing(const int fd, const size_t size, const off_t offset)
+{
+    void* addr = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd, offset);
+    return addr == MAP_FAILED ? nullptr : addr;
+}
+} // end of anonymous namespace
+
+IOUring::IOUring()
+: mFd(-1),
+  mSqRing(nullptr),
+  mSqRingSize(0),
+  mCqRing(nullptr),
+  mCqRingSize(0),
+  mSqes(nullptr),
+  mSqesSize(0),
+  mSqHead(nullptr),
+  mSqTail(nullptr),
+  mSqArray(nullptr),
+  mSqMask(0),
+  mSqEntries(0),
+  mSqLocalTail(0),
+  mCqHead(nullptr),
+  mCqTail(nullptr),
+  mCqMask(0),
+  mCqes(nullptr),
+  mExtArg(false),
+  mBufRing(nullptr),
+  mBufRingSize(0),
+  mBuffers(nullptr),
+  mBufferSize(0),
+  mBufferCount(0),
+  mBufferGroup(0)
+{
+}
+
+IOUring::~IOUring()
+{
+    close();
+}
+
+bool IOUring::setup(const unsigned entries)
+{
+    close();
+
+    // Deferring completion work to our own kernel entries saves interrupting the thread
+    struct io_uring_params params;
+    memset(&params, 0, sizeof(params));
+    params.flags = IORING_SETUP_COOP_TASKRUN;
+    mFd = ioUringSetup(entries, &params);
+    if (mFd < 0 && errno == EINVAL)
+    {
+        memset(&params, 0, sizeof(params));
+        mFd = ioUringSetup(entries, &params);
+    }
+    if (mFd < 0)
+    {
+        spdlog::warn("io_uring is not available: {}", strerror(errno));
+        return false;
+    }
+
+    mSqRingSize = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+    mCqRingSize = params.cq_off.cqes + params.cq_entries * sizeof(struct io_uring_cqe);
+    if (params.features & IORING_FEAT_SINGLE_MMAP)
+    {
+        mSqRingSize = std::max(mSqRingSize, mCqRingSize);
+        mCqRingSize = 0;
+    }
+    mSqesSize = params.sq_entries * sizeof(struct io_uring_sqe);
+
+    mSqRing = mapRing(mFd, mSqRingSize, IORING_OFF_SQ_RING);
+    mCqRing = mCqRingSize == 0 ? mSqRing : mapRing(mFd, mCqRingSize, IORING_OFF_CQ_RING);
+    mSqes = static_cast<struct io_uring_sqe*>(mapRing(mFd, mSqesSize, IORING_OFF_SQES));
+    if (mSqRing == nullptr || mCqRing == nullptr || mSqes == nullptr)
+    {
+        spdlog::warn("Failed to map the io_uring rings: {}", strerror(errno));
+        close();
+        return false;
+    }
+
+    uint8_t* sq = static_cast<uint8_t*>(mSqRing);
+    mSqHead = reinterpret_cast<unsigned*>(sq + params.sq_off.head);
+    mSqTail = reinterpret_cast<unsigned*>(sq + params.sq_off.tail);
+    mSqArray = reinterpret_cast<unsigned*>(sq + params.sq_off.array);
+    mSqMask = *reinterpret_cast<unsigned*>(sq + params.sq_off.ring_mask);
+    mSqEntries = params.sq_entries;
+    mSqLocalTail = *mSqTail;
+
+    uint8_t* cq = static_cast<uint8_t*>(mCqRing);
+    mCqHead = reinterpret_cast<unsigned*>(cq + params.cq_off.head);
+    mCqTail = reinterpret_cast<unsigned*>(cq + params.cq_off.tail);
+    mCqMask = *reinterpret_cast<unsigned*>(cq + params.cq_off.ring_mask);
+    mCqes = reinterpret_cast<struct io_uring_cqe*>(cq + params.cq_off.cqes);
+
+    mExtArg = (params.features & IORING_FEAT_EXT_ARG) != 0;
+    spdlog::info("io_uring set up with {} submission and {} completion entries", params.sq_entries, params.cq_entries);
+    return true;
+}
+
+void IOUring::close()
+{
+    if (mBuffers != nullptr)
+    {
+        munmap(mBuffers, static_cast<size_t>(mBufferCount) * mBufferSize);
+        mBuffers = nullptr;
+    }
+    if (mBufRing != nullptr)
+    {
+        munmap(mBufRing, mBufRingSize);
+        mBufRing = nullptr;
+    }
+    if (mSqes != nullptr)
+    {
+        munmap(mSqes, mSqesSize);
+        mSqes = nullptr;
+    }
+    if (mCqRing != nullptr && mCqRing != mSqRing)
+    {
+        munmap(mCqRing, mCqRingSize);
+    }
+    mCqRing = nullptr;
+    if (mSqRing != nullptr)
+    {
+        munmap(mSqRing, mSqRingSize);
+        mSqRing = nullptr;
+    }
+    if (mFd >= 0)
+    {
+        ::close(mFd);
+        mFd = -1;
+    }
+}
+
+struct io_uring_sqe* IOUring::getSqe()
+{
+    const unsigned head = __atomic_load_n(mSqHead, __ATOMIC_ACQUIRE);
+    if (mSqLocalTail - head >= mSqEntries)
+    {
+        return nullptr;
+    }
+
+    const unsigned index = mSqLocalTail & mSqMask;
+    struct io_uring_sqe* sqe = &mSqes[index];
+    memset(sqe, 0, sizeof(struct io_uring_sqe));
+    mSqArray[index] = index;
+    ++mSqLocalTail;
+    return sqe;
+}
+
+int IOUring::submit(const unsigned waitCount, const struct timespec* timeout)
+{
+    const unsigned toSubmit = mSqLocalTail - *mSqTail;
+    __atomic_store_n(mSqTail, mSqLocalTail, __ATOMIC_RELEASE);
+
+    unsigned flags = waitCount > 0 ? IORING_ENTER_GETEVENTS : 0;
+    struct io_uring_getevents_arg arg;
+    const void* argPtr = nullptr;
+    size_t argSize = 0;
+    if (timeout != nullptr && mExtArg)
+    {
+        memset(&arg, 0, sizeof(arg));
+        arg.ts = reinterpret_cast<uint64_t>(timeout);
+        flags |= IORING_ENTER_EXT_ARG;
+        argPtr = &arg;
+        argSize = sizeof(arg);
+    }
+
+    const int retVal = ioUringEnter(mFd, toSubmit, waitCount, flags, argPtr, argSize);
+    return retVal < 0 ? -errno : retVal;
+}
+
+struct io_uring_cqe* IOUring::peekCqe()
+{
+    const unsigned head = *mCqHead;
+    if (head == __atomic_load_n(mCqTail, __ATOMIC_ACQUIRE))
+    {
+        return nullptr;
+    }
+    return &mCqes[head & mCqMask];
+}
+
+void IOUring::seenCqe()
+{
+    __atomic_store_n(mCqHead, *mCqHead + 1, __ATOMIC_RELEASE);
+}
+
+bool IOUring::setupBufferRing(const uint16_t group, const uint16_t count, const size_t size)
+{
+    mBufRingSize = static_cast<size_t>(count) * sizeof(struct io_uring_buf);
+    void* ring = mmap(nullptr, mBufRingSize, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    void* buffers = mmap(nullptr, static_cast<size_t>(count) * size, PROT_READ | PROT_WRITE,
+                         MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (ring == MAP_FAILED || buffers == MAP_FAILED)
+    {
+        spdlog::warn("Failed to allocate io_uring provided buffers: {}", strerror(errno));
+        if (ring != MAP_FAILED)
+        {
+            munmap(ring, mBufRingSize);
+        }
+        if (buffers != MAP_FAILED)
+        {
+            munmap(buffers, static_cast<size_t>(count) * size);
+        }
+        return false;
+    }
+    mBufRing = static_cast<struct io_uring_buf_ring*>(ring);
+    mBuffers = static_cast<uint8_t*>(buffers);
+    mBufferSize = size;
+    mBufferCount = count;
+    mBufferGroup = group;
+
+    struct io_uring_buf_reg reg;
+    memset(&reg, 0, sizeof(reg));
+    reg.ring_addr = reinterpret_cast<uint64_t>(mBufRing);
+    reg.ring_entries = count;
+    reg.bgid = group;
+    if (ioUringRegister(mFd, IORING_REGISTER_PBUF_RING, &reg, 1) < 0)
+    {
+        spdlog::warn("Failed to register io_uring provided buffers: {}", strerror(errno));
+        return false;
+    }
+
+    // The tail overlays the reserved field of the first entry and starts at zero
+    for (uint16_t id = 0; id < count; ++id)
+    {
+        recycleBuffer(id);
+    }
+    return true;
+}
+
+void IOUring::recycleBuffer(const uint16_t id)
+{
+    // The entries start at the ring base: compiled as C++, the flexible bufs member of the
+    // uapi header sits after an empty struct and is not where the kernel reads the entries
+    const uint16_t tail = mBufRing->tail;
+    struct io_uring_buf& buf = reinterpret_cast<struct io_uring_buf*>(mBufRing)[tail & (mBufferCount - 1)];
+    buf.addr = reinterpret_cast<uint64_t>(getBuffer(id));
+    buf.len = static_cast<uint32_t>(mBufferSize);
+    buf.bid = id;
+    __atomic_store_n(&mBufRing->tail, static_cast<uint16_t>(tail + 1), __ATOMIC_RELEASE);
+}
@@ -0,0 +1,137 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <ctime>
+#include <linux/io_uring.h>
+
+/**
+ * @brief Minimal io_uring instance driven through the raw system calls
+ *
+ * Only what the socket paths need is wrapped: queueing submission entries,
+ * submitting them while optionally waiting for completions (with a timeout),
+ * reaping completions, and a single ring of provided buffers for multishot
+ * receives. The instance is owned and used by a single thread.
+ */
+class IOUring
+{
+public:
+    /**
+     * @brief Constructor initializes a closed instance
+     */
+    IOUring();
+
+    /**
+     * @brief Destructor releases the rings and the provided buffers
+     */
+    ~IOUring();
+
+    IOUring(const IOUring&) = delete;
+    IOUring& operator=(const IOUring&) = delete;
+
+    /**
+     * @brief Create the io_uring instance and map its rings
+     *
+     * @param entries Number of submission queue entries
+     * @return true on success, false if the kernel does not offer io_uring
+     */
+    bool setup(const unsigned entries);
+
+    /**
+     * @brief Unmap the rings and close the instance
+     */
+    void close();
+
+    /**
+     * @brief Check if the instance is set up
+     *
+     * @return true if setup() succeeded
+     */
+    inline bool isOpen() const { return mFd >= 0; }
+
+    /**
+     * @brief Check if waits for completions can time out (IORING_FEAT_EXT_ARG)
+     *
+     * @return true if submit() honours its timeout
+     */
+    inline bool supportsWaitTimeout() const { return mExtArg; }
+
+    /**
+     * @brief Get a cleared submission queue entry
+     *
+     * @return The entry, or nullptr if the submission queue is full
+     */
+    struct io_uring_sqe* getSqe();
+
+    /**
+     * @brief Submit the queued entries and wait for completions
+     *
+     * @param waitCount Number of completions to wait for, 0 to return right after submitting
+     * @param timeout Maximum time to wait, nullptr to wait without limit. Ignored unless supportsWaitTimeout()
+     * @return Number of submitted entries, or -errno (-ETIME on timeout)
+     */
+    int submit(const unsigned waitCount, const struct timespec* timeout = nullptr);
+
+    /**
+     * @brief Get the oldest completion without consuming it
+     *
+     * @return The completion, or nullptr if none is available
+     */
+    struct io_uring_cqe* peekCqe();
+
+    /**
+     * @brief Consume the completion returned by peekCqe()
+     */
+    void seenCqe();
+
+    /**
+     * @brief Register a ring of provided buffers
+     *
+     * @param group Buffer group id used by the receive entries
+     * @param count Number of buffers, a power of two
+     * @param size Size of each buffer in bytes
+     * @return true if the buffers were registered
+     */
+    bool setupBufferRing(const uint16_t group, const uint16_t count, const size_t size);
+
+    /**
+     * @brief Get a provided buffer
+     *
+     * @param id Buffer id reported by a completion
+     * @return Start of the buffer
+     */
+    inline uint8_t* getBuffer(const uint16_t id) const { return mBuffers + static_cast<size_t>(id) * mBufferSize; }
+
+    /**
+     * @brief Hand a provided buffer back to the kernel
+     *
+     * @param id Buffer id reported by a completion
+     */
+    void recycleBuffer(const uint16_t id);
+
+private:
+    int mFd;                          ///< io_uring file descriptor, -1 when closed
+    void* mSqRing;                    ///< Mapped submission ring
+    size_t mSqRingSize;               ///< Size of the submission ring mapping
+    void* mCqRing;                    ///< Mapped completion ring, may alias mSqRing
+    size_t mCqRingSize;               ///< Size of the completion ring mapping
+    struct io_uring_sqe* mSqes;       ///< Mapped submission queue entries
+    size_t mSqesSize;                 ///< Size of the entries mapping
+    unsigned* mSqHead;                ///< Submission head, advanced by the kernel
+    unsigned* mSqTail;                ///< Submission tail, advanced by us
+    unsigned* mSqArray;               ///< Submission index array
+    unsigned mSqMask;                 ///< Submission ring mask
+    unsigned mSqEntries;              ///< Number of submission entries
+    unsigned mSqLocalTail;            ///< Tail including entries not yet published to the kernel
+    unsigned* mCqHead;                ///< Completion head, advanced by us
+    unsigned* mCqTail;                ///< Completion tail, advanced by the kernel
+    unsigned mCqMask;                 ///< Completion ring mask
+    struct io_uring_cqe* mCqes;       ///< Completion entries
+    bool mExtArg;                     ///< true if waits accept a timeout argument
+    struct io_uring_buf_ring* mBufRing; ///< Ring of provided buffers, nullptr if none
+    size_t mBufRingSize;              ///< Size of the provided buffer ring mapping
+    uint8_t* mBuffers;                ///< Memory of the provided buffers
+    size_t mBufferSize;               ///< Size of each provided buffer
+    uint16_t mBufferCount;            ///< Number of provided buffers
+    uint16_t mBufferGroup;            ///< Group id of the provided buffers
+};
@@ -0,0 +1,82 @@
+#include "communication/SequenceTracker.h"
+
+SequenceTracker::SequenceTracker()
+{
+    reset();
+}
+
+void SequenceTracker::track(const uint64_t sequence)
+{
+    if (!mStarted)
+    {
+        mStarted = true;
+        mFirst = sequence;
+        mHighest = sequence;
+        mWindow = 1;
+        ++mReceived;
+        return;
+    }
+
+    if (sequence > mHighest)
+    {
+        // Newer sample, everything between the previous highest and this one is missing for now
+        const uint64_t shift = sequence - mHighest;
+        mLost += shift - 1;
+        mWindow = (shift >= WINDOW_SIZE) ? 0 : (mWindow << shift);
+        mWindow |= 1;
+        mHighest = sequence;
+        ++mReceived;
+        return;
+    }
+
+    const uint64_t offset = mHighest - sequence;
+    if (offset < WINDOW_SIZE && (mWindow & (1ULL << offset)) != 0)
+    {
+        ++mDuplicates;
+        return;
+    }
+
+    // A late sample fills a gap that was previously counted as lost
+    if (offset < WINDOW_SIZE)
+    {
+        mWindow |= (1ULL << offset);
+    }
+    ++mReordered;
+    ++mReceived;
+    if (mLost > 0)
+    {
+        --mLost;
+    }
+}
+
+void SequenceTracker::reset()
+{
+    mStarted = false;
+    mFirst = 0;
+    mPreviousSpan = 0;
+    mHighest = 0;
+    mWindow = 0;
+    mReceived = 0;
+    mLost = 0;
+    mDuplicates = 0;
+    mReordered = 0;
+}
+
+void SequenceTracker::restart()
+{
+    if (mStarted)
+    {
+        mPreviousSpan += mHighest - mFirst + 1;
+        mStarted = false;
+    }
+}
+
+double SequenceTracker::getLossRate() const
+{
+    const uint64_t span = mPreviousSpan + (mStarted ? mHighest - mFirst + 1 : 0);
+    if (span == 0)
+    {
+        return 0.0;
+    }
+    return 100.0 * static_cast<double>(mLost) / static_cast<double>(span);
+}
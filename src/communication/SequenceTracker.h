@@ -0,0 +1,88 @@
+#pragma once
+
+#include <cstdint>
+
+/**
+ * @brief Tracks sample sequence numbers to account for lost, duplicated and reordered samples
+ * 
+ * Gaps are counted as lost when they are observed. A sample that arrives late
+ * but within the tracking window is recognised as reordered and no longer
+ * counted as lost; a sample seen twice within the window is a duplicate.
+ */
+class SequenceTracker
+{
+public:
+    /** Number of most recent sequence numbers remembered for duplicate detection */
+    static constexpr uint64_t WINDOW_SIZE = 64;
+
+    /**
+     * @brief Constructor initializes an empty tracker
+     */
+    SequenceTracker();
+
+    /**
+     * @brief Account for a received sample
+     * 
+     * @param sequence Sequence number of the sample
+     */
+    void track(const uint64_t sequence);
+
+    /**
+     * @brief Forget all history and counters
+     */
+    void reset();
+
+    /**
+     * @brief Start tracking a new stream, for instance from a restarted publisher
+     * 
+     * The counters are kept, the next sample is taken as the first of the new
+     * stream instead of being compared with the sequence numbers seen so far.
+     */
+    void restart();
+
+    /**
+     * @brief Get the number of unique samples received
+     * 
+     * @return Number of received samples
+     */
+    inline uint64_t getReceived() const { return mReceived; }
+
+    /**
+     * @brief Get the number of samples that are missing
+     * 
+     * @return Number of lost samples
+     */
+    inline uint64_t getLost() const { return mLost; }
+
+    /**
+     * @brief Get the number of samples received more than once
+     * 
+     * @return Number of duplicates
+     */
+    inline uint64_t getDuplicates() const { return mDuplicates; }
+
+    /**
+     * @brief Get the number of samples received out of order
+     * 
+     * @return Number of reordered samples
+     */
+    inline uint64_t getReordered() const { return mReordered; }
+
+    /**
+     * @brief Get the percentage of samples lost since the first received one, over all streams
+     * 
+     * @return Loss rate in percent
+     */
+    double getLossRate() const;
+
+private:
+    bool mStarted;        ///< true once the first sample was tracked
+    uint64_t mFirst;      ///< Sequence number of the first tracked sample
+    uint64_t mPreviousSpan; ///< Number of sequence numbers covered by the streams tracked before a restart()
+    uint64_t mHighest;    ///< Highest sequence number seen so far
+    uint64_t mWindow;     ///< Bit i is set if sample mHighest - i was received
+    uint64_t mReceived;   ///< Number of unique samples received
+    uint64_t mLost;       ///< Number of missing samples
+    uint64_t mDuplicates; ///< Number of duplicated samples
+    uint64_t mReordered;  ///< Number of samples received out of order
+};
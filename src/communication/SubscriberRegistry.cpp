@@ -0,0 +1,36 @@
+#include "communication/SubscriberRegistry.h"
+
+SubscriberRegistry::Subscriber* SubscriberRegistry::add(const struct sockaddr_un& address, const uint32_t divider,
+                                                        const RateMode rateMode)
+{
+    auto inserted = mByPath.emplace(address.sun_path, nullptr);
+    if (!inserted.second)
+    {
+        return nullptr;
+    }
+    inserted.first->second = std::make_unique<Subscriber>(address, divider, rateMode);
+    return inserted.first->second.get();
+}
+
+void SubscriberRegistry::markEvicted(Subscriber& subscriber)
+{
+    if (!subscriber.mEvicted)
+    {
+        subscriber.mEvicted = true;
+        mEvicted.push_back(&subscriber);
+    }
+}
+
+std::vector<std::unique_ptr<SubscriberRegistry::Subscriber>> SubscriberRegistry::sweep()
+{
+    std::vector<std::unique_ptr<Subscriber>> removed;
+    removed.reserve(mEvicted.size());
+    for (Subscriber* subscriber : mEvicted)
+    {
+        auto it = mByPath.find(subscriber->mAddress.sun_path);
+        removed.push_back(std::move(it->second));
+        mByPath.erase(it);
+    }
+    mEvicted.clear();
+    return removed;
+}
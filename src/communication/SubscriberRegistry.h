@@ -0,0 +1,110 @@
+#pragma once
+
+#include <cstddef>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include <sys/uio.h>
+#include <sys/un.h>
+#include "core/FrameIMU.h"
+#include "core/RateMode.h"
+
+/**
+ * @brief Registry of subscribers keyed by socket path
+ *
+ * Registrations, sends and evictions all run on the publishing thread, so
+ * the registry takes no lock. Adding a subscriber and removing an evicted
+ * one are O(1): the publisher keeps its fan-out messages in step through
+ * the slot index every subscriber carries, instead of rebuilding them.
+ * Subscribers vanishing during a fan-out are only marked, and removed by
+ * the next sweep() so that the messages being sent stay valid.
+ */
+class SubscriberRegistry
+{
+public:
+    /**
+     * @brief A registered subscriber and its delivery counters
+     */
+    struct Subscriber
+    {
+        struct sockaddr_un mAddress;   ///< Subscriber socket address
+        uint64_t mSent;                ///< Number of samples handed to the subscriber socket
+        uint64_t mFailed;              ///< Number of samples dropped with EAGAIN/ENOBUFS
+        bool mEvicted;                 ///< Set by markEvicted(), removed by the next sweep()
+        size_t mSlot;                  ///< Index of its fan-out message, or in the reduced-rate list
+
+        // Slow subscriber handling
+        uint32_t mConsecutiveFailures; ///< Number of sends that failed in a row
+        bool mDegraded;                ///< true while the subscriber does not keep up
+        bool mHasPending;              ///< true if mPending waits to be retried
+        uint64_t mPendingSequence;     ///< Sequence number of the pending sample
+        Payload_IMU_t mPending;        ///< Latest undelivered sample
+
+        // Rate reduction negotiated at registration
+        uint32_t mDivider;             ///< Number of published samples per forwarded sample, 1 for full rate
+        RateMode mRateMode;            ///< How samples are reduced when mDivider > 1
+        uint32_t mPhase;               ///< Samples accumulated since the last forwarded one
+        Payload_IMU_t mAccumulator;    ///< Running sum of the accumulated samples with RateMode::AVERAGE
+        uint64_t mNextSequence;        ///< Sequence number of the next forwarded sample
+        std::unique_ptr<Frame_IMU_t> mFrame; ///< Own frame of a reduced-rate subscriber, null at full rate
+        struct iovec mFrameIov;        ///< Payload of the messages to a reduced-rate subscriber
+
+        Subscriber(const struct sockaddr_un& address, const uint32_t divider, const RateMode rateMode)
+        : mAddress(address), mSent(0), mFailed(0), mEvicted(false), mSlot(0),
+          mConsecutiveFailures(0), mDegraded(false), mHasPending(false), mPendingSequence(0), mPending(),
+          mDivider(divider), mRateMode(rateMode), mPhase(0), mAccumulator(), mNextSequence(0),
+          mFrame(divider > 1 ? new Frame_IMU_t() : nullptr), mFrameIov{mFrame.get(), 0}
+        {}
+    };
+
+    /** Subscribers by socket path, the registry owns them */
+    typedef std::unordered_map<std::string, std::unique_ptr<Subscriber>> Map;
+
+    SubscriberRegistry() = default;
+
+    SubscriberRegistry(const SubscriberRegistry&) = delete;
+    SubscriberRegistry& operator=(const SubscriberRegistry&) = delete;
+
+    /**
+     * @brief Register a subscriber
+     *
+     * @param address Socket address of the subscriber
+     * @param divider Number of published samples per sample forwarded to the subscriber
+     * @param rateMode How samples are reduced when divider > 1
+     * @return The new subscriber, nullptr if it was already registered
+     */
+    Subscriber* add(const struct sockaddr_un& address, const uint32_t divider, const RateMode rateMode);
+
+    /**
+     * @brief Mark a subscriber for removal by the next sweep()
+     *
+     * @param subscriber The subscriber to evict
+     */
+    void markEvicted(Subscriber& subscriber);
+
+    /**
+     * @brief Check if subscribers wait to be removed by sweep()
+     *
+     * @return true if a subscriber was marked since the last sweep()
+     */
+    inline bool hasEvictions() const { return !mEvicted.empty(); }
+
+    /**
+     * @brief Remove the subscribers marked for eviction
+     *
+     * @return The removed subscribers, handed over to the caller
+     */
+    std::vector<std::unique_ptr<Subscriber>> sweep();
+
+    /**
+     * @brief Get all registered subscribers, evicted ones included until the next sweep()
+     *
+     * @return The subscribers by socket path
+     */
+    inline const Map& getSubscribers() const { return mByPath; }
+
+private:
+    Map mByPath;                      ///< Registered subscribers by socket path
+    std::vector<Subscriber*> mEvicted; ///< Subscribers marked since the last sweep()
+};
@@ -0,0 +1,10 @@
+#pragma once
+
+/**
+ * @brief Enumeration of the scalar types the AHRS filters can run with
+ */
+enum class AHRSPrecision
+{
+    FLOAT,      ///< Single precision state and arithmetic
+    DOUBLE      ///< Double precision state and arithmetic
+};
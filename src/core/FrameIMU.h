@@ -0,0 +1,42 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include "core/PayloadIMU.h"
+
+/** Version of the framed wire format */
+inline constexpr uint16_t FRAME_VERSION = 2;
+
+/** Maximum number of samples carried by a single frame */
+inline constexpr uint16_t MAX_FRAME_SAMPLES = 64;
+
+/**
+ * A header preceding the samples of every datagram.
+ */
+typedef struct FrameHeader_s
+{
+    uint16_t version; // Wire format version, FRAME_VERSION
+    uint16_t sampleCount; // Number of samples following the header
+    uint64_t sequence; // Sequence number of the first sample in the frame
+} __attribute__((packed)) FrameHeader_t;
+
+/**
+ * A datagram carrying up to MAX_FRAME_SAMPLES IMU samples.
+ * Only the header and the first sampleCount samples are sent on the wire.
+ */
+typedef struct Frame_IMU_s
+{
+    FrameHeader_t header;
+    Payload_IMU_t samples[MAX_FRAME_SAMPLES];
+} __attribute__((packed)) Frame_IMU_t;
+
+/**
+ * @brief Get the size on the wire of a frame holding the given number of samples
+ * 
+ * @param sampleCount Number of samples in the frame
+ * @return Frame size in bytes
+ */
+inline constexpr size_t frameSize(const size_t sampleCount)
+{
+    return sizeof(FrameHeader_t) + sampleCount * sizeof(Payload_IMU_t);
+}
@@ -0,0 +1,10 @@
+#pragma once
+
+/**
+ * @brief Enumeration of the ways socket I/O is issued to the kernel
+ */
+enum class IoBackend
+{
+    SOCKET_CALLS,   ///< Batched socket system calls (sendmmsg/recvmmsg)
+    URING           ///< io_uring submissions, multishot receives into provided buffers
+};
@@ -0,0 +1,10 @@
+#pragma once
+
+/**
+ * @brief Enumeration of the publisher reactions to a missed period
+ */
+enum class OverrunPolicy
+{
+    CATCH_UP,   ///< Run the missed periods back-to-back to keep the average rate, skip those beyond one second
+    SKIP        ///< Drop the missed periods and realign to the next deadline
+};
@@ -1,7 +1,14 @@
 #pragma once
 
 #include <string> 
+#include <vector>
+#include "core/AHRSPrecision.h"
 #include "core/AHRSType.h"
+#include "core/IoBackend.h"
+#include "core/OverrunPolicy.h"
+#include "core/RateMode.h"
+#include "core/SlowSubscriberPolicy.h"
+#include "core/TransportType.h"
 
 /**
  * @brief Parameters structure for IMU publisher and subscriber
@@ -12,9 +19,37 @@
 struct Parameters
 {
     std::string mSocketPath; ///< Path to the Unix domain socket
+    std::string mControlSocketPath; ///< Path of a separate registration socket, empty to register on mSocketPath
     int mFrequencyHz;        ///< Publication frequency in Hz
     ulong mTimeoutMs;        ///< Timeout for socket operations in milliseconds
     AHRSType mAhrsType;      ///< AHRS algorithm to use
+    bool mIgnoreMagnetometer; ///< Run an AHRS fusing the gyroscope and accelerometer only
+    AHRSPrecision mAhrsPrecision; ///< Scalar type of the AHRS state and arithmetic
+    TransportType mTransport; ///< Transport used to deliver IMU samples
+    std::string mMulticastGroup; ///< IPv4 multicast group of the UDP transport
+    int mMulticastPort;      ///< UDP port of the multicast group
+    int mMulticastTtl;       ///< Time to live of multicast datagrams, 1 keeps them on the local network
+    std::string mMulticastInterface; ///< IPv4 address of the multicast interface, empty for the default route
+    int mSocketBufferBytes;  ///< SO_SNDBUF/SO_RCVBUF of the multicast sockets, 0 for the system default
+    bool mReusePort;         ///< Set SO_REUSEADDR and SO_REUSEPORT so that several local subscribers can share a group
+    int mBatchSize;          ///< Maximum number of samples per published frame
+    long mMaxBatchLatencyUs; ///< Maximum time a sample may wait in a frame, 0 to disable
+    int mRecvBatch;          ///< Maximum number of datagrams drained per receive call
+    IoBackend mIoBackend;    ///< How socket I/O is issued, falls back to socket calls without io_uring
+    ulong mStatsPeriodMs;    ///< Period of statistics logging in milliseconds, 0 to log on shutdown only
+    OverrunPolicy mOverrunPolicy; ///< Publisher reaction to missed periods
+    SlowSubscriberPolicy mSlowPolicy; ///< Publisher reaction to subscribers that do not keep up
+    int mEvictAfter;         ///< Consecutive failed sends before eviction with SlowSubscriberPolicy::EVICT
+    int mOutputRateHz;       ///< Rate requested by a subscriber in Hz, 0 for every published sample
+    RateMode mRateMode;      ///< How the publisher reduces the rate for a subscriber
+    bool mReconnect;         ///< Re-register on publisher timeout instead of exiting
+    ulong mReconnectBackoffMs; ///< Delay after the first failed reconnection round, doubled after each round
+    ulong mReconnectMaxBackoffMs; ///< Upper bound of the reconnection delay
+    std::vector<std::string> mStandbySocketPaths; ///< Publisher sockets tried in order when the primary one is gone
+    std::string mReplayFile; ///< Recording replayed by the publisher, empty for random samples
+    double mReplaySpeed;     ///< Replay speed relative to the recording, 0 for one sample per publishing period
+    bool mReplayLoop;        ///< Start the recording over at its end instead of holding its last sample
+    std::string mRecordFile; ///< Recording written by the subscriber, empty to record nothing
     bool mRealTime;          ///< Flag for real-time thread configuration
     int mPriority;           ///< Thread priority (1-99 for real-time)
     int mPolicy;             ///< Scheduling policy (SCHED_FIFO or SCHED_RR) for real-time
@@ -24,9 +59,37 @@ struct Parameters
      */
     Parameters() 
     : mSocketPath(""),
+      mControlSocketPath(""),
       mFrequencyHz(500),
       mTimeoutMs(100),
       mAhrsType(AHRSType::NONE),
+      mIgnoreMagnetometer(false),
+      mAhrsPrecision(AHRSPrecision::FLOAT),
+      mTransport(TransportType::SOCKET),
+      mMulticastGroup("239.255.0.1"),
+      mMulticastPort(30001),
+      mMulticastTtl(1),
+      mMulticastInterface(""),
+      mSocketBufferBytes(0),
+      mReusePort(false),
+      mBatchSize(1),
+      mMaxBatchLatencyUs(0),
+      mRecvBatch(1),
+      mIoBackend(IoBackend::SOCKET_CALLS),
+      mStatsPeriodMs(0),
+      mOverrunPolicy(OverrunPolicy::CATCH_UP),
+      mSlowPolicy(SlowSubscriberPolicy::DROP_NEWEST),
+      mEvictAfter(100),
+      mOutputRateHz(0),
+      mRateMode(RateMode::DECIMATE),
+      mReconnect(false),
+      mReconnectBackoffMs(10),
+      mReconnectMaxBackoffMs(1000),
+      mStandbySocketPaths(),
+      mReplayFile(""),
+      mReplaySpeed(1.0),
+      mReplayLoop(false),
+      mRecordFile(""),
       mRealTime(false),
       mPriority(50),
       mPolicy(SCHED_FIFO)
@@ -20,4 +20,6 @@ typedef struct Payload_IMU_s
     float yMag; // Magnetic induction y axis [mGauss]
     float zMag; // Magnetic induction z axis [mGauss]
     uint32_t timestampMag; // Time stamp of magnetometer measurement
+    uint64_t acquisitionNs; // CLOCK_MONOTONIC time the sample was acquired [ns]
+    uint64_t publishNs; // CLOCK_MONOTONIC time the sample was handed to the transport [ns]
 } __attribute__((packed)) Payload_IMU_t;
@@ -0,0 +1,42 @@
+#pragma once
+
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+
+/** Registration message sent by a subscriber to the publisher */
+inline constexpr char REG_MSG[9] = "REGISTER";
+
+/** Registration field requesting an output rate in Hz, e.g. "REGISTER rate=10" */
+inline constexpr char REG_RATE_FIELD[6] = "rate=";
+
+/** Registration field selecting how the rate is reduced, "decimate" or "average" */
+inline constexpr char REG_MODE_FIELD[6] = "mode=";
+
+/** Prefix of the publisher reply carrying the shared memory segment name */
+inline constexpr char SHM_MSG[5] = "SHM ";
+
+/** Publisher reply carrying the memfd of the ring as SCM_RIGHTS ancillary data */
+inline constexpr char MEMFD_MSG[6] = "MEMFD";
+
+/** Maximum size of a control message exchanged during registration */
+inline constexpr size_t CONTROL_MSG_SIZE = 128;
+
+/**
+ * @brief Get the divider of the publishing rate that serves a requested output rate
+ *
+ * Only integer divisions of the publishing rate can be served, the publisher
+ * and the subscriber both derive the rate actually delivered from it.
+ *
+ * @param publishingRateHz Publishing rate in Hz
+ * @param requestedRateHz Rate requested at registration in Hz, 0 for every sample
+ * @return Number of published samples per delivered sample, at least 1
+ */
+inline uint32_t rateDivider(const int publishingRateHz, const int requestedRateHz)
+{
+    if (requestedRateHz <= 0 || requestedRateHz >= publishingRateHz)
+    {
+        return 1;
+    }
+    return static_cast<uint32_t>(std::lround(static_cast<double>(publishingRateHz) / requestedRateHz));
+}
@@ -0,0 +1,10 @@
+#pragma once
+
+/**
+ * @brief Enumeration of the ways the publisher reduces the rate of a subscriber stream
+ */
+enum class RateMode
+{
+    DECIMATE,   ///< Forward every Nth sample
+    AVERAGE     ///< Forward the mean of every N samples
+};
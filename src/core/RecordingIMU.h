@@ -0,0 +1,18 @@
+#pragma once
+
+#include <cstdint>
+#include "core/PayloadIMU.h"
+
+/** "IMUREC" followed by the format version, at the start of every recording */
+inline constexpr char RECORDING_MAGIC[8] = {'I', 'M', 'U', 'R', 'E', 'C', '0', '1'};
+
+/**
+ * A header at the start of an IMU recording.
+ * It is followed by the recorded samples, each one a Payload_IMU_t in host byte order, oldest first.
+ */
+typedef struct RecordingHeader_s
+{
+    char magic[8]; // RECORDING_MAGIC
+    uint32_t sampleSize; // Size of every sample, sizeof(Payload_IMU_t)
+    uint32_t reserved; // Zero
+} __attribute__((packed)) RecordingHeader_t;
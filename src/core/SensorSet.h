@@ -0,0 +1,10 @@
+#pragma once
+
+/**
+ * @brief Enumeration of the sensors an AHRS filter is built to fuse
+ */
+enum class SensorSet
+{
+    GYRO_ACCEL,     ///< Gyroscope and accelerometer, the magnetometer is never read
+    GYRO_ACCEL_MAG  ///< Gyroscope, accelerometer and magnetometer
+};
@@ -0,0 +1,11 @@
+#pragma once
+
+/**
+ * @brief Enumeration of the publisher reactions to a subscriber whose socket buffer is full
+ */
+enum class SlowSubscriberPolicy
+{
+    DROP_NEWEST,   ///< Drop the frame that did not fit
+    KEEP_LATEST,   ///< Keep only the latest undelivered sample and retry it on the next frame
+    EVICT          ///< Evict the subscriber after a number of consecutive failures
+};
@@ -0,0 +1,23 @@
+#pragma once
+
+/**
+ * @brief Enumeration of available data transports between publisher and subscribers
+ */
+enum class TransportType
+{
+    SOCKET,     ///< One Unix domain datagram per sample and subscriber
+    SHM,        ///< Single-producer/multi-consumer ring in POSIX shared memory
+    MEMFD,      ///< Same ring in a sealed memfd handed to each subscriber over SCM_RIGHTS
+    UDP         ///< One UDP multicast datagram per frame, received by every member of the group
+};
+
+/**
+ * @brief Check if a transport delivers samples through a shared memory ring
+ *
+ * @param transport The transport to check
+ * @return true for the ring based transports
+ */
+inline constexpr bool isRingTransport(const TransportType transport)
+{
+    return transport == TransportType::SHM || transport == TransportType::MEMFD;
+}
@@ -0,0 +1,263 @@
+#include <algorithm>
+#include <cerrno>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <fcntl.h>
+#include <spdlog/spdlog.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "core/RecordingIMU.h"
+#include "providers/FileIMUDataProvider.h"
+
+namespace
+{
+inline constexpr size_t READAHEAD_WINDOW_BYTES = 4 * 1024 * 1024; ///< Prefetched ahead of the replay, a multiple of the page size
+inline constexpr size_t MAX_SKIPPED_PER_REQUEST = 4096; ///< Bounds the catch-up of one request after a stall
+inline constexpr uint64_t NSEC_PER_MSEC = 1000000ULL;
+
+/**
+ * @brief Recorded time between two consecutive samples in nanoseconds
+ *
+ * Uses the acquisition times, or the gyroscope timestamps for recordings
+ * without them. Time going backwards counts as no time.
+ */
+uint64_t intervalNs(const Payload_IMU_t& previous, const Payload_IMU_t& next)
+{
+    if (previous.acquisitionNs != 0 && next.acquisitionNs != 0)
+    {
+        return next.acquisitionNs > previous.acquisitionNs ? next.acquisitionNs - previous.acquisitionNs : 0;
+    }
+    // The difference of the 32-bit millisecond timestamps stays correct across their wrap-around
+    const int32_t elapsedMs = static_cast<int32_t>(next.timestampGyro - previous.timestampGyro);
+    return elapsedMs > 0 ? static_cast<uint64_t>(elapsedMs) * NSEC_PER_MSEC : 0;
+}
+} // end of anonymous namespace
+
+FileIMUDataProvider::FileIMUDataProvider(const std::string& path, const double speed, const bool loop,
+                                         const int publishingRateHz)
+: mPath(path),
+  mSpeed(speed),
+  mLoop(loop),
+  mNominalPeriodNs(std::max<uint64_t>(std::llround(1e9 * (speed > 0.0 ? speed : 1.0) / std::max(publishingRateHz, 1)), 1)),
+  mMapping(nullptr),
+  mMappingSize(0),
+  mSamples(nullptr),
+  mCount(0),
+  mIndex(0),
+  mOffsetNs(0),
+  mLoopBaseNs(0),
+  mPeriodNs(mNominalPeriodNs),
+  mStartNs(0),
+  mStartMs(0),
+  mPasses(0),
+  mSkipped(0),
+  mRepeated(0),
+  mAdvisedWindow(0),
+  mFinished(false)
+{
+}
+
+FileIMUDataProvider::~FileIMUDataProvider()
+{
+    if (mMapping != nullptr)
+    {
+        spdlog::info("Replay of {} stopped after {} complete passes: {} samples skipped, {} repeated", mPath, mPasses,
+                     mSkipped, mRepeated);
+        munmap(mMapping, mMappingSize);
+    }
+}
+
+bool FileIMUDataProvider::initialize()
+{
+    if (mMapping != nullptr)
+    {
+        munmap(mMapping, mMappingSize);
+        mMapping = nullptr;
+    }
+
+    const int fd = open(mPath.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0)
+    {
+        spdlog::error("Failed to open recording {}: {}", mPath, strerror(errno));
+        return false;
+    }
+    struct stat status;
+    if (fstat(fd, &status) < 0)
+    {
+        spdlog::error("Failed to get the size of recording {}: {}", mPath, strerror(errno));
+        close(fd);
+        return false;
+    }
+    const size_t size = static_cast<size_t>(status.st_size);
+    if (size < sizeof(RecordingHeader_t) + sizeof(Payload_IMU_t))
+    {
+        spdlog::error("Recording {} holds no sample ({} bytes)", mPath, size);
+        close(fd);
+        return false;
+    }
+
+    // The mapping keeps the file referenced, the descriptor is not needed any more
+    void* mapping = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (mapping == MAP_FAILED)
+    {
+        spdlog::error("Failed to map recording {}: {}", mPath, strerror(errno));
+        return false;
+    }
+
+    const RecordingHeader_t* header = static_cast<const RecordingHeader_t*>(mapping);
+    if (memcmp(header->magic, RECORDING_MAGIC, sizeof(RECORDING_MAGIC)) != 0 ||
+        header->sampleSize != sizeof(Payload_IMU_t))
+    {
+        spdlog::error("{} is not a recording of this sample layout", mPath);
+        munmap(mapping, size);
+        return false;
+    }
+
+    mMapping = mapping;
+    mMappingSize = size;
+    mSamples = reinterpret_cast<const Payload_IMU_t*>(static_cast<const uint8_t*>(mapping) + sizeof(RecordingHeader_t));
+    mCount = (size - sizeof(RecordingHeader_t)) / sizeof(Payload_IMU_t);
+    if ((size - sizeof(RecordingHeader_t)) % sizeof(Payload_IMU_t) != 0)
+    {
+        spdlog::warn("Recording {} ends with a truncated sample, ignored", mPath);
+    }
+
+    // Aggressive kernel readahead, and the window after the current one is prefetched on top of it
+    if (madvise(mMapping, mMappingSize, MADV_SEQUENTIAL) < 0)
+    {
+        spdlog::warn("Failed to advise sequential access to {}: {}", mPath, strerror(errno));
+    }
+    mAdvisedWindow = SIZE_MAX;
+    adviseWindow(0);
+
+    // Recordings whose timestamps do not advance loop at the nominal rate, so that every pass takes time
+    mPeriodNs = mCount > 1 ? intervalNs(mSamples[0], mSamples[mCount - 1]) / (mCount - 1) : 0;
+    if (mPeriodNs == 0)
+    {
+        mPeriodNs = mNominalPeriodNs;
+    }
+    mIndex = 0;
+    mOffsetNs = 0;
+    mLoopBaseNs = 0;
+    mStartNs = 0;
+    mFinished = false;
+    spdlog::info("Replaying {} samples from {} at {}{}", mCount, mPath,
+                 mSpeed > 0.0 ? fmt::format("{}x speed", mSpeed) : std::string("one sample per request"),
+                 mLoop ? ", looping" : "");
+    return true;
+}
+
+void FileIMUDataProvider::getIMUData(Payload_IMU_t& imuData)
+{
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    const uint64_t nowNs = static_cast<uint64_t>(now.tv_sec) * 1000000000ULL + now.tv_nsec;
+
+    uint64_t offsetNs;
+    if (mStartNs == 0)
+    {
+        // The first request starts the replay clock with the first sample
+        struct timespec wallClock;
+        clock_gettime(CLOCK_REALTIME, &wallClock);
+        mStartNs = nowNs;
+        mStartMs = static_cast<uint64_t>(wallClock.tv_sec) * 1000 + wallClock.tv_nsec / NSEC_PER_MSEC;
+    }
+    else if (mSpeed > 0.0)
+    {
+        // Hand out the newest sample that is due, skipping the older ones. A replay left far behind, or a
+        // recording of identical timestamps, catches up over several requests
+        const uint64_t dueNs = static_cast<uint64_t>((nowNs - mStartNs) * mSpeed);
+        bool advanced = false;
+        size_t skipped = 0;
+        while (skipped < MAX_SKIPPED_PER_REQUEST && nextOffset(offsetNs) && offsetNs <= dueNs)
+        {
+            skipped += advanced ? 1 : 0;
+            advance(offsetNs);
+            advanced = true;
+        }
+        mSkipped += skipped;
+        mRepeated += advanced ? 0 : 1;
+    }
+    else if (nextOffset(offsetNs))
+    {
+        advance(offsetNs);
+    }
+    else
+    {
+        ++mRepeated;
+    }
+
+    if (!mLoop && !mFinished && mIndex + 1 == mCount)
+    {
+        mFinished = true;
+        spdlog::info("Replay of {} reached its end, holding the last sample: {} samples skipped, {} repeated", mPath,
+                     mSkipped, mRepeated);
+    }
+
+    // Move the recorded times to the replay clock
+    imuData = mSamples[mIndex];
+    const double scale = mSpeed > 0.0 ? 1.0 / mSpeed : 1.0;
+    const Payload_IMU_t& first = mSamples[0];
+    const double loopBaseMs = static_cast<double>(mLoopBaseNs) / NSEC_PER_MSEC;
+    const auto toReplayMs = [&](const uint32_t timestampMs) {
+        const int32_t recordedMs = static_cast<int32_t>(timestampMs - first.timestampAcc);
+        return static_cast<uint32_t>(mStartMs + std::llround((loopBaseMs + recordedMs) * scale));
+    };
+    imuData.timestampAcc = toReplayMs(imuData.timestampAcc);
+    imuData.timestampGyro = toReplayMs(imuData.timestampGyro);
+    imuData.timestampMag = toReplayMs(imuData.timestampMag);
+    imuData.acquisitionNs = mStartNs + static_cast<uint64_t>(mOffsetNs * scale);
+    imuData.publishNs = 0;
+}
+
+bool FileIMUDataProvider::nextOffset(uint64_t& offsetNs) const
+{
+    if (mIndex + 1 < mCount)
+    {
+        offsetNs = mOffsetNs + intervalNs(mSamples[mIndex], mSamples[mIndex + 1]);
+        return true;
+    }
+    // The next pass starts one recorded period after the last sample
+    offsetNs = mOffsetNs + mPeriodNs;
+    return mLoop;
+}
+
+void FileIMUDataProvider::advance(const uint64_t offsetNs)
+{
+    if (++mIndex == mCount)
+    {
+        mIndex = 0;
+        mLoopBaseNs = offsetNs;
+        ++mPasses;
+        spdlog::debug("Replay of {} starts over, pass {}", mPath, mPasses + 1);
+    }
+    mOffsetNs = offsetNs;
+    adviseWindow(mIndex);
+}
+
+void FileIMUDataProvider::adviseWindow(const size_t index)
+{
+    const size_t window = (sizeof(RecordingHeader_t) + index * sizeof(Payload_IMU_t)) / READAHEAD_WINDOW_BYTES;
+    if (window == mAdvisedWindow)
+    {
+        return;
+    }
+    uint8_t* base = static_cast<uint8_t*>(mMapping);
+    const size_t nextStart = (window + 1) * READAHEAD_WINDOW_BYTES;
+    if (nextStart < mMappingSize)
+    {
+        madvise(base + nextStart, std::min(READAHEAD_WINDOW_BYTES, mMappingSize - nextStart), MADV_WILLNEED);
+    }
+    // Replayed pages are read again from the page cache if needed, there is no point in keeping them mapped
+    if (mAdvisedWindow != SIZE_MAX && window == mAdvisedWindow + 1)
+    {
+        const size_t previousStart = mAdvisedWindow * READAHEAD_WINDOW_BYTES;
+        madvise(base + previousStart, std::min(READAHEAD_WINDOW_BYTES, mMappingSize - previousStart), MADV_DONTNEED);
+    }
+    mAdvisedWindow = window;
+}
@@ -0,0 +1,113 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include "IMUDataProvider.h"
+
+/**
+ * @brief Implementation of IMUDataProvider that replays a recording
+ *
+ * The recording (see core/RecordingIMU.h) is memory-mapped read-only with
+ * sequential readahead, and every sample is copied straight out of the
+ * mapping, so replaying never allocates.
+ *
+ * The publisher asks for one sample per period. With a positive speed the
+ * recording runs on its own clock, started by the first request and scaled
+ * by the speed: every request gets the newest sample that is due, samples
+ * between two requests are skipped and a sample is repeated until the next
+ * one is due. Publishing at the recording rate times the speed delivers
+ * every sample once. Timestamps are moved to the replay clock, so latencies
+ * measured by the subscribers stay meaningful.
+ *
+ * With a speed of 0 every request gets the next sample, as fast as the
+ * publisher asks. Timestamps then keep the recorded spacing from the start
+ * of the replay, so that the AHRS of the subscribers integrates the
+ * recorded sample intervals whatever the publishing rate.
+ */
+class FileIMUDataProvider : public IMUDataProvider
+{
+public:
+    /**
+     * @brief Constructor with the recording and the replay settings
+     *
+     * @param path Path of the recording
+     * @param speed Replay speed relative to the recording, 0 for one sample per request
+     * @param loop Start over at the end of the recording instead of holding its last sample
+     * @param publishingRateHz Rate of the requests, gives the recording rate when its timestamps do not advance
+     */
+    FileIMUDataProvider(const std::string& path, const double speed = 1.0, const bool loop = false,
+                        const int publishingRateHz = 1000);
+
+    /**
+     * @brief Destructor unmaps the recording
+     */
+    virtual ~FileIMUDataProvider();
+
+    FileIMUDataProvider(const FileIMUDataProvider&) = delete;
+    FileIMUDataProvider& operator=(const FileIMUDataProvider&) = delete;
+
+    /**
+     * @brief Map the recording and check its header
+     *
+     * @return true if the recording holds at least one sample
+     */
+    virtual bool initialize() override;
+
+    /**
+     * @brief Get the sample due at the current replay time
+     *
+     * @param data Reference to the IMU data structure to fill
+     */
+    virtual void getIMUData(Payload_IMU_t& data) override;
+
+    /**
+     * @brief Check if the replay reached the end of a recording that does not loop
+     *
+     * @return true once the last sample was handed out
+     */
+    inline bool isFinished() const { return mFinished; }
+
+private:
+    /**
+     * @brief Get the recording time of the sample after the current one
+     *
+     * @param offsetNs Receives its time since the first sample of the replay
+     * @return false at the end of a recording that does not loop
+     */
+    bool nextOffset(uint64_t& offsetNs) const;
+
+    /**
+     * @brief Move to the sample after the current one, wrapping around at the end
+     *
+     * @param offsetNs Its time, as given by nextOffset()
+     */
+    void advance(const uint64_t offsetNs);
+
+    /**
+     * @brief Prefetch the readahead window after the one of a sample and drop the one before
+     *
+     * @param index Index of the sample about to be read
+     */
+    void adviseWindow(const size_t index);
+
+    std::string mPath;               ///< Path of the recording
+    double mSpeed;                   ///< Replay speed, 0 for one sample per request
+    bool mLoop;                      ///< Start over at the end of the recording
+    uint64_t mNominalPeriodNs;       ///< Recording period implied by the publishing rate and the speed
+    void* mMapping;                  ///< Mapping of the whole file, nullptr when not mapped
+    size_t mMappingSize;             ///< Size of the mapping
+    const Payload_IMU_t* mSamples;   ///< First sample in the mapping
+    size_t mCount;                   ///< Number of samples
+    size_t mIndex;                   ///< Index of the sample handed out last
+    uint64_t mOffsetNs;              ///< Recording time of mIndex since the first sample of the replay
+    uint64_t mLoopBaseNs;            ///< Recording time of the first sample of the current pass
+    uint64_t mPeriodNs;              ///< Mean sample interval, or mNominalPeriodNs, the gap inserted when looping
+    uint64_t mStartNs;               ///< CLOCK_MONOTONIC time of the first request, 0 before it
+    uint64_t mStartMs;               ///< CLOCK_REALTIME milliseconds of the first request
+    uint64_t mPasses;                ///< Completed passes through the recording
+    uint64_t mSkipped;               ///< Samples skipped because they were overtaken by a newer one
+    uint64_t mRepeated;              ///< Requests answered with the previous sample
+    size_t mAdvisedWindow;           ///< Readahead window requested last
+    bool mFinished;                  ///< The last sample of a recording that does not loop was reached
+};
@@ -21,6 +21,8 @@ bool RandomIMUDataProvider::initialize()
 void RandomIMUDataProvider::getIMUData(Payload_IMU_t& imuData)
 {
     struct timespec ts;
+    struct timespec acquisition;
+    clock_gettime(CLOCK_MONOTONIC, &acquisition);
     clock_gettime(CLOCK_REALTIME, &ts);
 
     imuData.xAcc = mAccDist(mGen);
@@ -37,4 +39,7 @@ void RandomIMUDataProvider::getIMUData(Payload_IMU_t& imuData)
     imuData.yMag = mMagDist(mGen);
     imuData.zMag = mMagDist(mGen);
     imuData.timestampMag = imuData.timestampAcc;
+
+    imuData.acquisitionNs = static_cast<uint64_t>(acquisition.tv_sec) * 1000000000ULL + acquisition.tv_nsec;
+    imuData.publishNs = 0;
 } 
\ No newline at end of file
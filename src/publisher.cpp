@@ -1,10 +1,12 @@
 #include <iostream>
+#include <memory>
 #include <semaphore.h>
 #include <signal.h>
 #include <spdlog/spdlog.h>
 
 #include "communication/IMUPublisher.h"
 #include "core/Parameters.h"
+#include "providers/FileIMUDataProvider.h"
 #include "providers/RandomIMUDataProvider.h"
 #include "utils/utils.h"
 
@@ -15,11 +17,28 @@ void printUsage(const char* programName)
     std::cout << "Usage: " << programName << " --socket-path <path> [options]\n"
               << "Options:\n"
               << "  --socket-path  : Unix domain socket path\n"
+              << "  --control-socket-path : Separate socket path for registrations (optional)\n"
               << "  --log-level    : Logging level (TRACE, DEBUG, INFO, WARN, ERROR)\n"
               << "  --frequency-hz : Publication frequency in Hz\n"
               << "  --real-time    : Enable real-time thread configuration\n"
               << "  --priority     : Thread priority (1-99, only with --real-time)\n"
-              << "  --policy       : Scheduling policy (FIFO or RR, only with --real-time)\n";
+              << "  --policy       : Scheduling policy (FIFO or RR, only with --real-time)\n"
+              << "  --transport    : Data transport (socket, shm, memfd or udp)\n"
+              << "  --multicast-group : IPv4 multicast group of the udp transport\n"
+              << "  --multicast-port : UDP port of the multicast group\n"
+              << "  --multicast-ttl : Time to live of multicast datagrams\n"
+              << "  --multicast-interface : IPv4 address of the interface used for multicast\n"
+              << "  --socket-buffer-bytes : SO_SNDBUF of the multicast socket (0 for the system default)\n"
+              << "  --io-backend   : Socket I/O backend (socket or uring)\n"
+              << "  --batch-size   : Maximum number of samples per datagram (1-64)\n"
+              << "  --max-batch-latency-us : Maximum time a sample may wait for its datagram\n"
+              << "  --stats-period-ms : Period of statistics logging in ms (0 logs on shutdown only)\n"
+              << "  --overrun-policy : Reaction to a missed period (catch-up or skip)\n"
+              << "  --slow-policy  : Reaction to a full subscriber socket (drop-newest, keep-latest or evict)\n"
+              << "  --evict-after  : Consecutive failed sends before eviction with --slow-policy evict\n"
+              << "  --replay-file  : Recording to publish instead of random samples\n"
+              << "  --replay-speed : Replay speed relative to the recording (0 for one sample per period)\n"
+              << "  --replay-loop  : Start the recording over at its end\n";
 }
 
 void signalHandler(int signum)
@@ -30,12 +49,6 @@ void signalHandler(int signum)
 
 int main(int argc, char* argv[])
 {
-    // Create the random data provider
-    RandomIMUDataProvider dataProvider;
-    
-    // Create the publisher with the data provider and real-time setting
-    IMUPublisher publisher(dataProvider);
-    
     Parameters params;
     sem_init(&sem_waiter, 0, 0);
 
@@ -50,6 +63,21 @@ int main(int argc, char* argv[])
         return 1;
     }
 
+    // Replay a recording if one was given, generate random samples otherwise
+    std::unique_ptr<IMUDataProvider> dataProvider;
+    if (params.mReplayFile.empty())
+    {
+        dataProvider = std::make_unique<RandomIMUDataProvider>();
+    }
+    else
+    {
+        dataProvider = std::make_unique<FileIMUDataProvider>(params.mReplayFile, params.mReplaySpeed,
+                                                             params.mReplayLoop, params.mFrequencyHz);
+    }
+
+    // Create the publisher with the data provider
+    IMUPublisher publisher(*dataProvider);
+
     // register signal handlers
     signal(SIGINT, signalHandler);
     signal(SIGTERM, signalHandler);
@@ -13,12 +13,31 @@ void printUsage(const char* programName)
     std::cout << "Usage: " << programName << " --socket-path <path> [options]\n"
               << "Options:\n"
               << "  --socket-path  : Unix domain socket path\n"
+              << "  --control-socket-path : Separate socket path for registrations (optional)\n"
               << "  --log-level    : Logging level (TRACE, DEBUG, INFO, WARN, ERROR)\n"
               << "  --timeout-ms   : Timeout in ms\n"
               << "  --ahrs-type    : AHRS algorithm (none, madgwick, simple)\n"
+              << "  --no-magnetometer : Fuse the gyroscope and accelerometer only\n"
+              << "  --ahrs-precision : Scalar type of the AHRS (float or double)\n"
               << "  --real-time    : Enable real-time thread configuration\n"
               << "  --priority     : Thread priority (1-99, only with --real-time)\n"
-              << "  --policy       : Scheduling policy (FIFO or RR, only with --real-time)\n";
+              << "  --policy       : Scheduling policy (FIFO or RR, only with --real-time)\n"
+              << "  --transport    : Data transport (socket, shm, memfd or udp)\n"
+              << "  --multicast-group : IPv4 multicast group of the udp transport\n"
+              << "  --multicast-port : UDP port of the multicast group\n"
+              << "  --multicast-interface : IPv4 address of the interface used for multicast\n"
+              << "  --socket-buffer-bytes : SO_RCVBUF of the multicast socket (0 for the system default)\n"
+              << "  --reuse-port   : Share the multicast group port with other local subscribers\n"
+              << "  --recv-batch   : Maximum number of datagrams drained per receive call\n"
+              << "  --io-backend   : Socket I/O backend (socket or uring)\n"
+              << "  --stats-period-ms : Period of statistics logging in ms (0 logs on shutdown only)\n"
+              << "  --output-rate-hz : Rate requested from the publisher in Hz (0 for every sample)\n"
+              << "  --rate-mode    : How the publisher reduces the rate (decimate or average)\n"
+              << "  --reconnect    : Re-register on publisher timeout instead of exiting\n"
+              << "  --reconnect-backoff-ms : Delay after the first failed reconnection round in ms\n"
+              << "  --reconnect-max-backoff-ms : Upper bound of the reconnection delay in ms\n"
+              << "  --standby-socket-path : Publisher socket to fail over to, may be repeated\n"
+              << "  --record-file  : Record the received samples for --replay-file\n";
 }
 
 void signalHandler(int signum)
@@ -0,0 +1,84 @@
+#include <algorithm>
+#include <cmath>
+
+#include "utils/LatencyHistogram.h"
+
+LatencyHistogram::LatencyHistogram()
+{
+    reset();
+}
+
+void LatencyHistogram::record(const uint64_t valueNs)
+{
+    ++mBuckets[bucketIndex(valueNs)];
+    ++mCount;
+    mSum += valueNs;
+    mMax = std::max(mMax, valueNs);
+}
+
+void LatencyHistogram::reset()
+{
+    mBuckets.fill(0);
+    mCount = 0;
+    mSum = 0;
+    mMax = 0;
+}
+
+void LatencyHistogram::merge(const LatencyHistogram& other)
+{
+    for (size_t i = 0; i < BUCKETS; ++i)
+    {
+        mBuckets[i] += other.mBuckets[i];
+    }
+    mCount += other.mCount;
+    mSum += other.mSum;
+    mMax = std::max(mMax, other.mMax);
+}
+
+uint64_t LatencyHistogram::getPercentile(const double percentile) const
+{
+    if (mCount == 0)
+    {
+        return 0;
+    }
+
+    const double clamped = std::clamp(percentile, 0.0, 100.0);
+    const uint64_t rank = std::max<uint64_t>(1, static_cast<uint64_t>(std::ceil(clamped / 100.0 * mCount)));
+    uint64_t seen = 0;
+    for (size_t i = 0; i < BUCKETS; ++i)
+    {
+        seen += mBuckets[i];
+        if (seen >= rank)
+        {
+            return std::min(bucketUpperBound(i), mMax);
+        }
+    }
+    return mMax;
+}
+
+size_t LatencyHistogram::bucketIndex(const uint64_t value)
+{
+    if (value < SUB_BUCKETS)
+    {
+        return value;
+    }
+    // Position of the most significant bit selects the group, the next bits the sub-bucket
+    const int msb = 63 - __builtin_clzll(value);
+    const int shift = msb - SUB_BUCKET_BITS;
+    const size_t group = shift + 1;
+    const size_t subBucket = (value >> shift) & (SUB_BUCKETS - 1);
+    return group * SUB_BUCKETS + subBucket;
+}
+
+uint64_t LatencyHistogram::bucketUpperBound(const size_t index)
+{
+    const size_t group = index / SUB_BUCKETS;
+    const uint64_t subBucket = index % SUB_BUCKETS;
+    if (group == 0)
+    {
+        return subBucket;
+    }
+    const int shift = group - 1;
+    const uint64_t lower = (SUB_BUCKETS + subBucket) << shift;
+    return lower + ((1ULL << shift) - 1);
+}
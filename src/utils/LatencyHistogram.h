@@ -0,0 +1,92 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+
+/**
+ * @brief Fixed-size log-linear histogram of durations in nanoseconds
+ * 
+ * Values are grouped into buckets whose width grows with the magnitude of the
+ * value (in the spirit of HDR histograms), which keeps the relative error of
+ * every reported percentile below ~3% over the whole 64-bit range. Recording a
+ * value never allocates, so the histogram can be updated from real-time loops.
+ */
+class LatencyHistogram
+{
+public:
+    /**
+     * @brief Constructor initializes an empty histogram
+     */
+    LatencyHistogram();
+
+    /**
+     * @brief Record a single value
+     * 
+     * @param valueNs The value in nanoseconds
+     */
+    void record(const uint64_t valueNs);
+
+    /**
+     * @brief Remove all recorded values
+     */
+    void reset();
+
+    /**
+     * @brief Add all values recorded by another histogram
+     * 
+     * @param other The histogram to merge into this one
+     */
+    void merge(const LatencyHistogram& other);
+
+    /**
+     * @brief Get the value below which the given percentage of recorded values fall
+     * 
+     * @param percentile Percentile in the range [0, 100]
+     * @return The percentile value in nanoseconds, 0 if the histogram is empty
+     */
+    uint64_t getPercentile(const double percentile) const;
+
+    /**
+     * @brief Get the number of recorded values
+     * 
+     * @return The number of values
+     */
+    inline uint64_t getCount() const { return mCount; }
+
+    /**
+     * @brief Get the largest recorded value
+     * 
+     * @return The maximum in nanoseconds
+     */
+    inline uint64_t getMax() const { return mMax; }
+
+    /**
+     * @brief Get the mean of recorded values
+     * 
+     * @return The mean in nanoseconds
+     */
+    inline double getMean() const { return mCount > 0 ? static_cast<double>(mSum) / mCount : 0.0; }
+
+private:
+    /** Number of bits used to split every power of two into linear sub-buckets */
+    static constexpr int SUB_BUCKET_BITS = 5;
+    /** Number of linear sub-buckets per power of two */
+    static constexpr uint64_t SUB_BUCKETS = 1ULL << SUB_BUCKET_BITS;
+    /** Total number of buckets needed to cover 64-bit values */
+    static constexpr size_t BUCKETS = (64 - SUB_BUCKET_BITS + 1) * SUB_BUCKETS;
+
+    /**
+     * @brief Map a value to its bucket
+     */
+    static size_t bucketIndex(const uint64_t value);
+
+    /**
+     * @brief Get the largest value that maps to a bucket
+     */
+    static uint64_t bucketUpperBound(const size_t index);
+
+    std::array<uint64_t, BUCKETS> mBuckets; ///< Number of values per bucket
+    uint64_t mCount;                        ///< Number of recorded values
+    uint64_t mSum;                          ///< Sum of recorded values
+    uint64_t mMax;                          ///< Largest recorded value
+};
@@ -0,0 +1,120 @@
+#include <cerrno>
+#include <cstring>
+#include <fcntl.h>
+#include <spdlog/spdlog.h>
+#include <unistd.h>
+
+#include "utils/RecordingWriter.h"
+
+namespace
+{
+/**
+ * @brief Write a whole buffer, resuming after partial writes and signals
+ *
+ * @return true if every byte was written
+ */
+bool writeAll(const int fd, const void* data, const size_t size)
+{
+    const uint8_t* cursor = static_cast<const uint8_t*>(data);
+    size_t remaining = size;
+    while (remaining > 0)
+    {
+        const ssize_t written = ::write(fd, cursor, remaining);
+        if (written < 0)
+        {
+            if (errno == EINTR)
+            {
+                continue;
+            }
+            return false;
+        }
+        cursor += written;
+        remaining -= static_cast<size_t>(written);
+    }
+    return true;
+}
+} // end of anonymous namespace
+
+RecordingWriter::RecordingWriter()
+: mPath(),
+  mFd(-1),
+  mBuffered(0),
+  mWritten(0),
+  mBuffer()
+{
+}
+
+RecordingWriter::~RecordingWriter()
+{
+    close();
+}
+
+bool RecordingWriter::open(const std::string& path)
+{
+    close();
+    const int fd = ::open(path.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+    if (fd < 0)
+    {
+        spdlog::error("Failed to create recording {}: {}", path, strerror(errno));
+        return false;
+    }
+
+    RecordingHeader_t header;
+    memcpy(header.magic, RECORDING_MAGIC, sizeof(RECORDING_MAGIC));
+    header.sampleSize = sizeof(Payload_IMU_t);
+    header.reserved = 0;
+    if (!writeAll(fd, &header, sizeof(header)))
+    {
+        spdlog::error("Failed to write the header of recording {}: {}", path, strerror(errno));
+        ::close(fd);
+        return false;
+    }
+
+    mPath = path;
+    mFd = fd;
+    mBuffered = 0;
+    mWritten = 0;
+    spdlog::info("Recording received samples to {}", mPath);
+    return true;
+}
+
+void RecordingWriter::write(const Payload_IMU_t* samples, const size_t count)
+{
+    for (size_t i = 0; i < count && isOpen(); ++i)
+    {
+        mBuffer[mBuffered++] = samples[i];
+        if (mBuffered == BUFFERED_SAMPLES && !flush())
+        {
+            close();
+        }
+    }
+}
+
+void RecordingWriter::close()
+{
+    if (!isOpen())
+    {
+        return;
+    }
+    flush();
+    ::close(mFd);
+    mFd = -1;
+    spdlog::info("Recording {} closed after {} samples", mPath, mWritten);
+}
+
+bool RecordingWriter::flush()
+{
+    const size_t count = mBuffered;
+    mBuffered = 0;
+    if (count == 0)
+    {
+        return true;
+    }
+    if (!writeAll(mFd, mBuffer.data(), count * sizeof(Payload_IMU_t)))
+    {
+        spdlog::error("Failed to write to recording {}: {}", mPath, strerror(errno));
+        return false;
+    }
+    mWritten += count;
+    return true;
+}
@@ -0,0 +1,76 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <string>
+#include "core/RecordingIMU.h"
+
+/**
+ * @brief Writer of IMU recordings, as replayed by FileIMUDataProvider
+ *
+ * Writes the recording header followed by the raw samples (see
+ * core/RecordingIMU.h). Samples are gathered in a fixed buffer and written
+ * in blocks, so recording never allocates. A failed write closes the
+ * recording, the samples written before it stay readable.
+ */
+class RecordingWriter
+{
+public:
+    /** Number of samples gathered before they are written to the file */
+    static constexpr size_t BUFFERED_SAMPLES = 256;
+
+    /**
+     * @brief Constructor of a closed writer
+     */
+    RecordingWriter();
+
+    /**
+     * @brief Destructor writes the buffered samples and closes the recording
+     */
+    ~RecordingWriter();
+
+    RecordingWriter(const RecordingWriter&) = delete;
+    RecordingWriter& operator=(const RecordingWriter&) = delete;
+
+    /**
+     * @brief Create or truncate a recording and write its header
+     *
+     * @param path Path of the recording
+     * @return true if the recording is open
+     */
+    bool open(const std::string& path);
+
+    /**
+     * @brief Append samples to the recording, nothing happens if it is closed
+     *
+     * @param samples The samples, oldest first
+     * @param count Number of samples
+     */
+    void write(const Payload_IMU_t* samples, const size_t count);
+
+    /**
+     * @brief Write the buffered samples and close the recording
+     */
+    void close();
+
+    /**
+     * @brief Check if samples are being recorded
+     *
+     * @return true between a successful open() and close()
+     */
+    inline bool isOpen() const { return mFd >= 0; }
+
+private:
+    /**
+     * @brief Write the buffered samples to the file
+     *
+     * @return true if all of them were written
+     */
+    bool flush();
+
+    std::string mPath;    ///< Path of the recording
+    int mFd;              ///< Descriptor of the recording, -1 when closed
+    size_t mBuffered;     ///< Number of samples in mBuffer
+    uint64_t mWritten;    ///< Number of samples written to the file
+    std::array<Payload_IMU_t, BUFFERED_SAMPLES> mBuffer; ///< Samples waiting to be written
+};
@@ -0,0 +1,23 @@
+#pragma once
+
+#include <pthread.h>
+
+/**
+ * @brief RAII guard locking a pthread mutex for the lifetime of the object
+ */
+class ScopedLock
+{
+public:
+    explicit ScopedLock(pthread_mutex_t& lock) : mLock(lock)
+    {
+        pthread_mutex_lock(&mLock);
+    }
+
+    virtual ~ScopedLock()
+    {
+        pthread_mutex_unlock(&mLock);
+    }
+
+private:
+    pthread_mutex_t& mLock;
+};
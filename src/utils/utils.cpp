@@ -1,7 +1,9 @@
 #include <getopt.h>
 #include <spdlog/spdlog.h>
 #include <sched.h>
+#include <sys/uio.h>
 
+#include "core/FrameIMU.h"
 #include "core/Parameters.h"
 #include "utils/utils.h"
 
@@ -46,11 +48,39 @@ bool parseParameters(int argc, char* argv[], Parameters& params)
         {"real-time", no_argument, 0, 'r'},
         {"priority", required_argument, 0, 'p'},
         {"policy", required_argument, 0, 'P'},
+        {"transport", required_argument, 0, 'T'},
+        {"batch-size", required_argument, 0, 'b'},
+        {"max-batch-latency-us", required_argument, 0, 'L'},
+        {"recv-batch", required_argument, 0, 'R'},
+        {"stats-period-ms", required_argument, 0, 'S'},
+        {"overrun-policy", required_argument, 0, 'O'},
+        {"slow-policy", required_argument, 0, 'D'},
+        {"evict-after", required_argument, 0, 'E'},
+        {"output-rate-hz", required_argument, 0, 'o'},
+        {"rate-mode", required_argument, 0, 'm'},
+        {"control-socket-path", required_argument, 0, 'c'},
+        {"multicast-group", required_argument, 0, 'g'},
+        {"multicast-port", required_argument, 0, 'N'},
+        {"multicast-ttl", required_argument, 0, 'y'},
+        {"multicast-interface", required_argument, 0, 'i'},
+        {"socket-buffer-bytes", required_argument, 0, 'B'},
+        {"reuse-port", no_argument, 0, 'u'},
+        {"io-backend", required_argument, 0, 'I'},
+        {"reconnect", no_argument, 0, 'x'},
+        {"reconnect-backoff-ms", required_argument, 0, 'k'},
+        {"reconnect-max-backoff-ms", required_argument, 0, 'K'},
+        {"standby-socket-path", required_argument, 0, 'w'},
+        {"no-magnetometer", no_argument, 0, 'n'},
+        {"ahrs-precision", required_argument, 0, 'q'},
+        {"replay-file", required_argument, 0, 'F'},
+        {"replay-speed", required_argument, 0, 'X'},
+        {"replay-loop", no_argument, 0, 'Z'},
+        {"record-file", required_argument, 0, 'W'},
         {0, 0, 0, 0}
     };
 
     int opt;
-    while ((opt = getopt_long(argc, argv, "s:l:f:t:a:rp:P:", long_options, nullptr)) != -1)
+    while ((opt = getopt_long(argc, argv, "s:l:f:t:a:rp:P:T:b:L:R:S:O:D:E:o:m:c:g:N:y:i:B:uI:xk:K:w:nq:F:X:ZW:", long_options, nullptr)) != -1)
     {
         switch (opt)
         {
@@ -125,6 +155,339 @@ bool parseParameters(int argc, char* argv[], Parameters& params)
                     }
                 }
                 break;
+            case 'T':
+                {
+                    std::string transport = optarg;
+                    if (transport == "socket")
+                    {
+                        params.mTransport = TransportType::SOCKET;
+                        spdlog::info("Transport: Unix domain socket");
+                    }
+                    else if (transport == "shm")
+                    {
+                        params.mTransport = TransportType::SHM;
+                        spdlog::info("Transport: shared memory ring");
+                    }
+                    else if (transport == "memfd")
+                    {
+                        params.mTransport = TransportType::MEMFD;
+                        spdlog::info("Transport: memfd ring");
+                    }
+                    else if (transport == "udp")
+                    {
+                        params.mTransport = TransportType::UDP;
+                        spdlog::info("Transport: UDP multicast");
+                    }
+                    else
+                    {
+                        spdlog::error("Invalid transport (must be socket, shm, memfd or udp): {}", transport);
+                        return false;
+                    }
+                }
+                break;
+            case 'b':
+                {
+                    int batchSize = std::stoi(optarg);
+                    if (batchSize >= 1 && batchSize <= MAX_FRAME_SAMPLES)
+                    {
+                        params.mBatchSize = batchSize;
+                        spdlog::info("Batch size: {} samples", batchSize);
+                    }
+                    else
+                    {
+                        spdlog::error("Invalid batch size (must be 1-{}): {}", MAX_FRAME_SAMPLES, batchSize);
+                        return false;
+                    }
+                }
+                break;
+            case 'L':
+                params.mMaxBatchLatencyUs = std::stol(optarg);
+                spdlog::info("Maximum batch latency: {} us", params.mMaxBatchLatencyUs);
+                break;
+            case 'R':
+                {
+                    int recvBatch = std::stoi(optarg);
+                    if (recvBatch >= 1 && recvBatch <= UIO_MAXIOV)
+                    {
+                        params.mRecvBatch = recvBatch;
+                        spdlog::info("Receive batch: {} datagrams", recvBatch);
+                    }
+                    else
+                    {
+                        spdlog::error("Invalid receive batch (must be 1-{}): {}", UIO_MAXIOV, recvBatch);
+                        return false;
+                    }
+                }
+                break;
+            case 'S':
+                params.mStatsPeriodMs = std::stoul(optarg);
+                spdlog::info("Statistics period: {} ms", params.mStatsPeriodMs);
+                break;
+            case 'O':
+                {
+                    std::string policy = optarg;
+                    if (policy == "catch-up")
+                    {
+                        params.mOverrunPolicy = OverrunPolicy::CATCH_UP;
+                        spdlog::info("Overrun policy: catch up");
+                    }
+                    else if (policy == "skip")
+                    {
+                        params.mOverrunPolicy = OverrunPolicy::SKIP;
+                        spdlog::info("Overrun policy: skip");
+                    }
+                    else
+                    {
+                        spdlog::error("Invalid overrun policy (must be catch-up or skip): {}", policy);
+                        return false;
+                    }
+                }
+                break;
+            case 'D':
+                {
+                    std::string policy = optarg;
+                    if (policy == "drop-newest")
+                    {
+                        params.mSlowPolicy = SlowSubscriberPolicy::DROP_NEWEST;
+                        spdlog::info("Slow subscriber policy: drop newest");
+                    }
+                    else if (policy == "keep-latest")
+                    {
+                        params.mSlowPolicy = SlowSubscriberPolicy::KEEP_LATEST;
+                        spdlog::info("Slow subscriber policy: keep latest");
+                    }
+                    else if (policy == "evict")
+                    {
+                        params.mSlowPolicy = SlowSubscriberPolicy::EVICT;
+                        spdlog::info("Slow subscriber policy: evict");
+                    }
+                    else
+                    {
+                        spdlog::error("Invalid slow subscriber policy (must be drop-newest, keep-latest or evict): {}", policy);
+                        return false;
+                    }
+                }
+                break;
+            case 'E':
+                {
+                    int evictAfter = std::stoi(optarg);
+                    if (evictAfter >= 1)
+                    {
+                        params.mEvictAfter = evictAfter;
+                        spdlog::info("Evict after: {} consecutive failed sends", evictAfter);
+                    }
+                    else
+                    {
+                        spdlog::error("Invalid eviction threshold (must be at least 1): {}", evictAfter);
+                        return false;
+                    }
+                }
+                break;
+            case 'o':
+                {
+                    int outputRate = std::stoi(optarg);
+                    if (outputRate >= 0)
+                    {
+                        params.mOutputRateHz = outputRate;
+                        spdlog::info("Output rate: {} Hz", outputRate);
+                    }
+                    else
+                    {
+                        spdlog::error("Invalid output rate (must be 0 or positive): {}", outputRate);
+                        return false;
+                    }
+                }
+                break;
+            case 'm':
+                {
+                    std::string mode = optarg;
+                    if (mode == "decimate")
+                    {
+                        params.mRateMode = RateMode::DECIMATE;
+                        spdlog::info("Rate mode: decimate");
+                    }
+                    else if (mode == "average")
+                    {
+                        params.mRateMode = RateMode::AVERAGE;
+                        spdlog::info("Rate mode: average");
+                    }
+                    else
+                    {
+                        spdlog::error("Invalid rate mode (must be decimate or average): {}", mode);
+                        return false;
+                    }
+                }
+                break;
+            case 'c':
+                params.mControlSocketPath = optarg;
+                spdlog::info("Control socket path: {}", params.mControlSocketPath);
+                break;
+            case 'g':
+                params.mMulticastGroup = optarg;
+                spdlog::info("Multicast group: {}", params.mMulticastGroup);
+                break;
+            case 'N':
+                {
+                    int port = std::stoi(optarg);
+                    if (port >= 1 && port <= 65535)
+                    {
+                        params.mMulticastPort = port;
+                        spdlog::info("Multicast port: {}", port);
+                    }
+                    else
+                    {
+                        spdlog::error("Invalid multicast port (must be between 1 and 65535): {}", port);
+                        return false;
+                    }
+                }
+                break;
+            case 'y':
+                {
+                    int ttl = std::stoi(optarg);
+                    if (ttl >= 0 && ttl <= 255)
+                    {
+                        params.mMulticastTtl = ttl;
+                        spdlog::info("Multicast TTL: {}", ttl);
+                    }
+                    else
+                    {
+                        spdlog::error("Invalid multicast TTL (must be between 0 and 255): {}", ttl);
+                        return false;
+                    }
+                }
+                break;
+            case 'i':
+                params.mMulticastInterface = optarg;
+                spdlog::info("Multicast interface: {}", params.mMulticastInterface);
+                break;
+            case 'B':
+                {
+                    int bufferBytes = std::stoi(optarg);
+                    if (bufferBytes >= 0)
+                    {
+                        params.mSocketBufferBytes = bufferBytes;
+                        spdlog::info("Socket buffer size: {} bytes", bufferBytes);
+                    }
+                    else
+                    {
+                        spdlog::error("Invalid socket buffer size (must be 0 or positive): {}", bufferBytes);
+                        return false;
+                    }
+                }
+                break;
+            case 'u':
+                params.mReusePort = true;
+                spdlog::info("Reuse port: enabled");
+                break;
+            case 'I':
+                {
+                    std::string backend = optarg;
+                    if (backend == "socket")
+                    {
+                        params.mIoBackend = IoBackend::SOCKET_CALLS;
+                        spdlog::info("I/O backend: socket calls");
+                    }
+                    else if (backend == "uring")
+                    {
+                        params.mIoBackend = IoBackend::URING;
+                        spdlog::info("I/O backend: io_uring");
+                    }
+                    else
+                    {
+                        spdlog::error("Invalid I/O backend (must be socket or uring): {}", backend);
+                        return false;
+                    }
+                }
+                break;
+            case 'x':
+                params.mReconnect = true;
+                spdlog::info("Reconnect: enabled");
+                break;
+            case 'k':
+                {
+                    long backoffMs = std::stol(optarg);
+                    if (backoffMs > 0)
+                    {
+                        params.mReconnectBackoffMs = backoffMs;
+                        spdlog::info("Reconnect backoff: {} ms", backoffMs);
+                    }
+                    else
+                    {
+                        spdlog::error("Invalid reconnect backoff (must be positive): {}", backoffMs);
+                        return false;
+                    }
+                }
+                break;
+            case 'K':
+                {
+                    long maxBackoffMs = std::stol(optarg);
+                    if (maxBackoffMs > 0)
+                    {
+                        params.mReconnectMaxBackoffMs = maxBackoffMs;
+                        spdlog::info("Reconnect maximum backoff: {} ms", maxBackoffMs);
+                    }
+                    else
+                    {
+                        spdlog::error("Invalid reconnect maximum backoff (must be positive): {}", maxBackoffMs);
+                        return false;
+                    }
+                }
+                break;
+            case 'w':
+                params.mStandbySocketPaths.push_back(optarg);
+                spdlog::info("Standby socket path: {}", params.mStandbySocketPaths.back());
+                break;
+            case 'n':
+                params.mIgnoreMagnetometer = true;
+                spdlog::info("Magnetometer: ignored");
+                break;
+            case 'q':
+                {
+                    std::string precision(optarg);
+                    if (precision == "float")
+                    {
+                        params.mAhrsPrecision = AHRSPrecision::FLOAT;
+                        spdlog::info("AHRS precision: float");
+                    }
+                    else if (precision == "double")
+                    {
+                        params.mAhrsPrecision = AHRSPrecision::DOUBLE;
+                        spdlog::info("AHRS precision: double");
+                    }
+                    else
+                    {
+                        spdlog::error("Invalid AHRS precision (must be float or double): {}", precision);
+                        return false;
+                    }
+                }
+                break;
+            case 'F':
+                params.mReplayFile = optarg;
+                spdlog::info("Replay file: {}", params.mReplayFile);
+                break;
+            case 'X':
+                {
+                    double speed = std::stod(optarg);
+                    if (speed >= 0.0)
+                    {
+                        params.mReplaySpeed = speed;
+                        spdlog::info("Replay speed: {}", speed);
+                    }
+                    else
+                    {
+                        spdlog::error("Invalid replay speed (must be positive, or 0 for one sample per period): {}", speed);
+                        return false;
+                    }
+                }
+                break;
+            case 'Z':
+                params.mReplayLoop = true;
+                spdlog::info("Replay loop: enabled");
+                break;
+            case 'W':
+                params.mRecordFile = optarg;
+                spdlog::info("Record file: {}", params.mRecordFile);
+                break;
             default:
                 return false;
         }